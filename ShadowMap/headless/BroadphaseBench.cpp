@@ -0,0 +1,135 @@
+#include "BroadphaseBench.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr GE::BroadphaseType TYPES[] = {GE::BroadphaseType::Dbvt, GE::BroadphaseType::AxisSweep,
+                                            GE::BroadphaseType::AxisSweep32, GE::BroadphaseType::Grid};
+    constexpr int COUNTS[] = {1000, 10000, 50000};
+    constexpr float RADIUS = 0.5f;
+    // Roughly one body per 4x4x4 cell whatever the count, like a busy scene.
+    constexpr float VOLUME_PER_BODY = 64.0f;
+
+    struct Mover
+    {
+        btCollisionObject *object;
+        btVector3 velocity;
+    };
+
+    struct Result
+    {
+        double msPerFrame;
+        int pairs;
+    };
+
+    Result Run(GE::BroadphaseType type, int count, unsigned int frames)
+    {
+        const float half = 0.5f * std::cbrt(count * VOLUME_PER_BODY);
+
+        GE::PhysicsConfig config;
+        config.broadphase = type;
+        config.worldMin = glm::vec3{-half};
+        config.worldMax = glm::vec3{half};
+        config.maxBodies = count + 16;
+        config.gridCellSize = 4.0f * RADIUS;
+        config.shapeCacheDirectory.clear();
+        GE::Physics physics{config};
+
+        // Everything gets the same seed, so every broadphase sees the same motion.
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> position(-half + RADIUS, half - RADIUS);
+        std::uniform_real_distribution<float> speed(-5.0f, 5.0f);
+
+        btCollisionShape *sphere = physics.shapes.getSphere(RADIUS);
+        std::vector<Mover> movers;
+        movers.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            btCollisionObject *object = new btCollisionObject();
+            object->setCollisionShape(sphere);
+            object->getWorldTransform().setOrigin(btVector3(position(rng), position(rng), position(rng)));
+            physics.dynamicsWorld->addCollisionObject(object);
+            movers.push_back({object, btVector3(speed(rng), speed(rng), speed(rng))});
+        }
+
+        const float dt = 1.0f / 60.0f;
+        double total = 0.0;
+        for (unsigned int f = 0; f < frames; ++f)
+        {
+            for (Mover &m : movers)
+            {
+                btVector3 p = m.object->getWorldTransform().getOrigin() + m.velocity * dt;
+                for (int a = 0; a < 3; ++a)
+                    if (p[a] < -half + RADIUS || p[a] > half - RADIUS)
+                        m.velocity[a] = -m.velocity[a];
+                m.object->getWorldTransform().setOrigin(p);
+            }
+
+            auto t0 = std::chrono::steady_clock::now();
+            physics.dynamicsWorld->updateAabbs();
+            physics.broadphase->calculateOverlappingPairs(physics.dispatcher);
+            auto t1 = std::chrono::steady_clock::now();
+            total += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        }
+
+        Result result{frames ? total / frames : 0.0, physics.broadphase->getOverlappingPairCache()->getNumOverlappingPairs()};
+
+        for (Mover &m : movers)
+        {
+            physics.dynamicsWorld->removeCollisionObject(m.object);
+            delete m.object;
+        }
+        physics.shapes.release(sphere);
+        return result;
+    }
+} // namespace
+
+bool ParseBroadphase(const std::string &name, GE::BroadphaseType &type)
+{
+    for (GE::BroadphaseType t : TYPES)
+        if (name == BroadphaseName(t))
+        {
+            type = t;
+            return true;
+        }
+    return false;
+}
+
+const char *BroadphaseName(GE::BroadphaseType type)
+{
+    switch (type)
+    {
+    case GE::BroadphaseType::AxisSweep:
+        return "sap";
+    case GE::BroadphaseType::AxisSweep32:
+        return "sap32";
+    case GE::BroadphaseType::Grid:
+        return "grid";
+    case GE::BroadphaseType::Dbvt:
+    default:
+        return "dbvt";
+    }
+}
+
+void RunBroadphaseBench(int maxBodies, unsigned int frames)
+{
+    std::printf("%-8s %8s %12s %10s\n", "broad", "bodies", "ms/frame", "pairs");
+    for (int count : COUNTS)
+    {
+        if (count > maxBodies)
+            break;
+        for (GE::BroadphaseType type : TYPES)
+        {
+            // 16 bit sweep and prune runs out of handles past 32k.
+            if (type == GE::BroadphaseType::AxisSweep && count > 32000)
+                continue;
+            Result r = Run(type, count, frames);
+            std::printf("%-8s %8d %12.3f %10d\n", BroadphaseName(type), count, r.msPerFrame, r.pairs);
+        }
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef BROADPHASEBENCH_HPP
+#define BROADPHASEBENCH_HPP
+
+#include <string>
+
+#include "Physics.hpp"
+
+// "dbvt", "sap", "sap32" or "grid"; false for anything else.
+bool ParseBroadphase(const std::string &name, GE::BroadphaseType &type);
+const char *BroadphaseName(GE::BroadphaseType type);
+
+// Pair finding only: for every broadphase and 1k, 10k, 50k bodies (up to
+// maxBodies), moves equally sized spheres through the world box and times
+// updateAabbs() + calculateOverlappingPairs(), without narrowphase or solver.
+void RunBroadphaseBench(int maxBodies, unsigned int frames);
+
+#endif
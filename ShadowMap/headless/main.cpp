@@ -0,0 +1,507 @@
+// Headless physics driver: no window, no GL context.
+// Builds GE::Physics + GE::EntityManager, spawns entities on a fixed script and
+// reports how long every simulation step takes.
+//
+// usage: headless_bench [--steps N] [--spawn-every N] [--csv file] [--threads N] [--broadphase NAME]
+//                       [--broadphase-bench N] [--load-snapshot file] [--save-snapshot file]
+//                       [--record file] [--replay file] [--lod 0|1] [--pile N]
+//                       [--static-boxes N] [--merge-statics 0|1] [--stats file] [--debris 0|1]
+//                       [--sphere-batch 0|1] [--particles N] [--queries N]
+//        --threads: 0 = single threaded world (default), N = btDiscreteDynamicsWorldMt on N threads, -1 = all cores
+//        --broadphase: dbvt (default), sap, sap32 or grid
+//        --broadphase-bench: compare pair finding of every broadphase at 1k/10k/50k bodies, up to N, and exit
+//        --load-snapshot: start from a saved world (e.g. an already settled pile) instead of an empty one
+//        --save-snapshot: save the world after the last step
+//        --record: save the spawns of this run as an input recording
+//        --static-boxes: a grid of N static boxes on the ground, obstacles for the projectiles
+//        --merge-statics: fold the ground and the static boxes into one BVH triangle mesh body (default 1)
+//        --stats: log Bullet's profile timings and world counts of every step, CSV or JSON lines (*.json),
+//                 and count the CCD sweeps (the ccd_swept column of --csv stays 0 without it)
+//        --debris: projectiles only collide with the world, not with each other (default 0)
+//        --sphere-batch: batched sphere-sphere and sphere-box contacts in the single threaded world (default 1)
+//        --particles: N cosmetic debris particles (no bodies) raining on the ground, updated every step and timed apart
+//        --queries: N downward rays and N sphere sweeps over the ground after every step, batched across the scheduler's threads
+//        --pile: drop a block of N balls (one spawnSpheres batch) before the first step
+//        --lod: put far bodies to sleep early (default 1), the viewer sits at the origin looking down -z
+//        --replay: launch the spawns of a recording (e.g. one made in the windowed demo) instead of the script
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <btBulletDynamicsCommon.h>
+
+#include "Physics.hpp"
+#include "EntityManager.hpp"
+#include "Entity.hpp"
+#include "BroadphaseBench.hpp"
+#include "WorldSnapshot.hpp"
+#include "InputRecording.hpp"
+#include "Particles.hpp"
+
+namespace
+{
+    constexpr float FIXED_DT = 1.0f / 60.0f;
+
+    struct StepSample
+    {
+        unsigned int step;
+        double ms;
+        int bodies;
+        int manifolds;
+        unsigned int ccdSwept;
+    };
+
+    // Only the "v x y z" lines are needed to build a hull, so a full model
+    // loader (and its GL buffers) is not required here.
+    std::vector<float> LoadObjPositions(const std::string &path)
+    {
+        std::vector<float> positions;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.size() < 2 || line[0] != 'v' || line[1] != ' ')
+                continue;
+            std::istringstream ss(line.substr(2));
+            float x, y, z;
+            if (ss >> x >> y >> z)
+            {
+                positions.push_back(x);
+                positions.push_back(y);
+                positions.push_back(z);
+            }
+        }
+        return positions;
+    }
+
+    // Same launch pattern as the shotThe* handlers in the windowed demo: fast
+    // projectiles from a point above the ground, slowly sweeping around.
+    GE::RecordedSpawn Script(unsigned int frame, unsigned int n)
+    {
+        static const GE::EntityType types[] = {GE::EntityType::Ball, GE::EntityType::ThrowingCube, GE::EntityType::Donut};
+        float angle = 0.05f * n;
+        glm::vec3 dir = glm::normalize(glm::vec3{glm::sin(angle), -0.3f, glm::cos(angle)});
+        glm::vec3 position{-20.0f * dir.x, 20.0f, -20.0f * dir.z};
+        return {frame, types[n % 3], glm::vec3{1, 1, 1}, position, 50.0f * dir, glm::mat4{1.0f}};
+    }
+
+    bool Launch(GE::Physics &physics, GE::EntityManager &entities, const std::vector<float> &donut, const GE::RecordedSpawn &s)
+    {
+        switch (s.type)
+        {
+        case GE::EntityType::Ball:
+            physics.addSphereBOX(entities.createEntity<Ball>(nullptr, s.position, s.velocity, s.size.x), s.position, s.size.x, s.velocity, {});
+            return true;
+        case GE::EntityType::ThrowingCube:
+            physics.addRigidBOX(entities.createEntity<ThrowingCube>(nullptr, s.position, s.size, s.velocity, s.rotation), s.position, s.size, s.velocity, s.rotation, {});
+            return true;
+        case GE::EntityType::Donut:
+            if (donut.empty())
+                return false;
+            physics.addDecomposedModel(entities.createEntity<Donut>(nullptr, s.position, s.velocity, s.size.x), "donut_model", "models/donut.obj.hulls", donut.data(), donut.size(), s.position, s.velocity, s.rotation, {});
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Recreates an entity of a snapshot that the scripted setup did not create.
+    GE::Entity *Respawn(GE::Physics &physics, GE::EntityManager &entities, const std::vector<float> &donut, GE::EntityType type, glm::vec3 scale, int flags)
+    {
+        auto cf = static_cast<btCollisionObject::CollisionFlags>(flags);
+        glm::vec3 origin{0};
+        glm::mat4 rot{1.0f};
+        switch (type)
+        {
+        case GE::EntityType::Ball:
+        {
+            Ball &b = entities.createEntity<Ball>(nullptr, origin, origin, scale.x);
+            physics.addSphereBOX(b, origin, scale.x, origin, cf);
+            return &b;
+        }
+        case GE::EntityType::ThrowingCube:
+        {
+            ThrowingCube &c = entities.createEntity<ThrowingCube>(nullptr, origin, scale, origin, rot);
+            physics.addRigidBOX(c, origin, scale, origin, rot, cf);
+            return &c;
+        }
+        case GE::EntityType::Donut:
+        {
+            if (donut.empty())
+                return nullptr;
+            Donut &d = entities.createEntity<Donut>(nullptr, origin, origin, scale.x);
+            physics.addDecomposedModel(d, "donut_model", "models/donut.obj.hulls", donut.data(), donut.size(), origin, origin, rot, cf);
+            return &d;
+        }
+        case GE::EntityType::Ground:
+        {
+            glm::vec2 dimensions{scale.x, scale.z};
+            Ground &g = entities.createEntity<Ground>(nullptr, origin, dimensions, rot);
+            physics.add2DBOX(g, origin, dimensions, rot, cf);
+            return &g;
+        }
+        default:
+            return nullptr;
+        }
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    unsigned int steps = 2000;
+    unsigned int spawn_every = 3;
+    const char *csv_path = nullptr;
+    int threads = 0;
+    GE::BroadphaseType broadphase = GE::BroadphaseType::Dbvt;
+    int broadphase_bench = 0;
+    const char *load_snapshot = nullptr;
+    const char *save_snapshot = nullptr;
+    const char *record_path = nullptr;
+    const char *replay_path = nullptr;
+    bool lod = true;
+    unsigned int pile = 0;
+    unsigned int static_boxes = 0;
+    bool merge_statics = true;
+    const char *stats_path = nullptr;
+    bool debris = false;
+    bool sphere_batch = true;
+    unsigned int particle_count = 0;
+    unsigned int query_count = 0;
+
+    for (int i = 1; i < argc; i += 2)
+    {
+        std::string opt = argv[i];
+        if (i + 1 == argc)
+            std::printf("missing value for %s\n", argv[i]);
+        else if (opt == "--steps")
+            steps = std::atoi(argv[i + 1]);
+        else if (opt == "--spawn-every")
+            spawn_every = std::atoi(argv[i + 1]);
+        else if (opt == "--csv")
+            csv_path = argv[i + 1];
+        else if (opt == "--threads")
+            threads = std::atoi(argv[i + 1]);
+        else if (opt == "--broadphase")
+        {
+            if (!ParseBroadphase(argv[i + 1], broadphase))
+                std::printf("unknown broadphase %s\n", argv[i + 1]);
+        }
+        else if (opt == "--broadphase-bench")
+            broadphase_bench = std::atoi(argv[i + 1]);
+        else if (opt == "--load-snapshot")
+            load_snapshot = argv[i + 1];
+        else if (opt == "--save-snapshot")
+            save_snapshot = argv[i + 1];
+        else if (opt == "--record")
+            record_path = argv[i + 1];
+        else if (opt == "--replay")
+            replay_path = argv[i + 1];
+        else if (opt == "--static-boxes")
+            static_boxes = std::atoi(argv[i + 1]);
+        else if (opt == "--merge-statics")
+            merge_statics = std::atoi(argv[i + 1]) != 0;
+        else if (opt == "--stats")
+            stats_path = argv[i + 1];
+        else if (opt == "--debris")
+            debris = std::atoi(argv[i + 1]) != 0;
+        else if (opt == "--sphere-batch")
+            sphere_batch = std::atoi(argv[i + 1]) != 0;
+        else if (opt == "--particles")
+            particle_count = std::atoi(argv[i + 1]);
+        else if (opt == "--queries")
+            query_count = std::atoi(argv[i + 1]);
+        else if (opt == "--pile")
+            pile = std::atoi(argv[i + 1]);
+        else if (opt == "--lod")
+            lod = std::atoi(argv[i + 1]) != 0;
+        else
+            std::printf("unknown option %s\n", argv[i]);
+    }
+
+    if (broadphase_bench > 0)
+    {
+        RunBroadphaseBench(broadphase_bench, steps < 300 ? steps : 300);
+        return 0;
+    }
+
+    GE::PhysicsConfig config;
+    config.broadphase = broadphase;
+    config.multithreaded = threads != 0;
+    config.numThreads = threads > 0 ? threads : 0;
+    // Stepped and queried from this thread alone, so the scheduler can serve the batches too.
+    config.parallelQueries = true;
+    config.lod.enabled = lod;
+    config.profile = stats_path != nullptr;
+    config.batchSphereContacts = sphere_batch;
+
+    GE::EntityManager EntManager;
+    GE::Physics WorldPhysics{config};
+    WorldPhysics.collisionFilter.setDebris(debris);
+    std::printf("physics threads: %d  query threads: %d  broadphase: %s\n", config.multithreaded ? WorldPhysics.getNumThreads() : 1,
+                WorldPhysics.getNumThreads(), BroadphaseName(broadphase));
+
+    std::vector<float> donut = LoadObjPositions("models/donut.obj");
+    if (donut.empty())
+        std::printf("models/donut.obj not found, donuts will not be spawned\n");
+
+    auto rotation = glm::mat4(1);
+    auto position = glm::vec3{0, 0, 0};
+    auto dimensions = glm::vec2{20, 20};
+    WorldPhysics.add2DBOX(EntManager.createEntity<Ground>(nullptr, position, dimensions, rotation),
+                          position, dimensions, rotation, btCollisionObject::CollisionFlags::CF_STATIC_OBJECT);
+
+    if (static_boxes > 0)
+    {
+        unsigned int side = static_cast<unsigned int>(std::ceil(std::sqrt(static_boxes)));
+        glm::vec3 size{0.5f, 0.5f, 0.5f};
+        for (unsigned int i = 0; i < static_boxes; ++i)
+        {
+            glm::vec3 p{36.0f * ((i % side) + 0.5f) / side - 18.0f, 0.5f, 36.0f * ((i / side) + 0.5f) / side - 18.0f};
+            WorldPhysics.addRigidBOX(EntManager.createEntity<ThrowingCube>(nullptr, p, size, glm::vec3{0}, rotation), p, size, glm::vec3{0}, rotation,
+                                     btCollisionObject::CollisionFlags::CF_STATIC_OBJECT);
+        }
+    }
+
+    if (merge_statics)
+    {
+        Ground &statics = EntManager.createEntity<Ground>(nullptr, glm::vec3{0}, glm::vec2{1, 1});
+        auto t0 = std::chrono::steady_clock::now();
+        std::size_t merged = WorldPhysics.mergeStatics(statics, "headless_statics");
+        auto t1 = std::chrono::steady_clock::now();
+        if (merged)
+            std::printf("merged %zu static bodies in %.1f ms\n", merged, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        else
+            EntManager.destroyEntity(&statics);
+    }
+
+    if (load_snapshot)
+    {
+        GE::WorldSnapshot snapshot;
+        if (snapshot.load(load_snapshot))
+        {
+            snapshot.restore(WorldPhysics, EntManager, [&](GE::EntityType type, glm::vec3 scale, int flags)
+                             { return Respawn(WorldPhysics, EntManager, donut, type, scale, flags); });
+            for (const auto &d : WorldPhysics.despawned)
+                EntManager.destroyEntity(d.entity);
+            WorldPhysics.despawned.clear();
+            std::printf("restored %zu bodies from %s\n", snapshot.records.size(), load_snapshot);
+        }
+        else
+            std::printf("could not load snapshot %s\n", load_snapshot);
+    }
+
+    if (pile > 0)
+    {
+        // Layers of up to 8x8 balls, 2.5 apart, stacked over the middle of the ground.
+        unsigned int side = static_cast<unsigned int>(std::ceil(std::sqrt(pile < 64 ? pile : 64)));
+        std::vector<glm::vec3> positions(pile);
+        for (unsigned int i = 0; i < pile; ++i)
+        {
+            unsigned int layer = i / (side * side), cell = i % (side * side);
+            positions[i] = {2.5f * (cell % side) - 1.25f * side, 5.0f + 2.5f * layer, 2.5f * (cell / side) - 1.25f * side};
+        }
+
+        // The entities are built outside the timed region, their constructors print.
+        float radius = 1.0f;
+        auto balls = EntManager.createEntities<Ball>(nullptr, pile, [&](std::size_t i)
+                                                     { return Ball(positions[i], glm::vec3{0}, radius); });
+        auto t0 = std::chrono::steady_clock::now();
+        WorldPhysics.spawnSpheres(balls, positions, {}, radius, {});
+        auto t1 = std::chrono::steady_clock::now();
+        std::printf("pile of %u balls added to the world in %.1f ms\n", pile, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+
+    // Same ground as the bodies: the 40x40 slab, with a plane far below it.
+    GE::DebrisParticles particles;
+    particles.capacity = particle_count;
+    particles.lifetime = 1e9f;
+    particles.groundPlane = false;
+    particles.boxes.push_back({position - glm::vec3{dimensions.x, 1.0f, dimensions.y}, position + glm::vec3{dimensions.x, 0.0f, dimensions.y}});
+    {
+        std::mt19937 rng{7};
+        std::uniform_real_distribution<float> across(-18.0f, 18.0f), up(2.0f, 40.0f), drift(-2.0f, 2.0f);
+        for (unsigned int i = 0; i < particle_count; ++i)
+            particles.spawn({across(rng), up(rng), across(rng)}, {drift(rng), 0.0f, drift(rng)}, 0.2f);
+    }
+    double particleMs = 0.0;
+
+    // A fixed grid of probes over the ground, the same every step.
+    std::vector<GE::RayQuery> rays(query_count);
+    std::vector<GE::SweepQuery> sweeps(query_count);
+    std::vector<GE::QueryHit> rayHits(query_count), sweepHits(query_count);
+    for (unsigned int i = 0; i < query_count; ++i)
+    {
+        const float u = 36.0f * ((i * 37) % 101) / 101.0f - 18.0f, v = 36.0f * ((i * 61) % 103) / 103.0f - 18.0f;
+        rays[i] = {{u, 50.0f, v}, {u, -5.0f, v}};
+        sweeps[i] = {{u, 50.0f, v}, {u, -5.0f, v}, 0.5f};
+    }
+    double queryMs = 0.0;
+    std::size_t rayHitCount = 0, sweepHitCount = 0;
+
+    GE::InputRecording script;
+    std::unique_ptr<GE::InputReplay> replay;
+    if (replay_path)
+    {
+        GE::InputRecording recording;
+        if (recording.load(replay_path))
+        {
+            std::printf("replaying %zu spawns from %s\n", recording.spawns.size(), replay_path);
+            replay = std::make_unique<GE::InputReplay>(std::move(recording));
+        }
+        else
+            std::printf("could not load recording %s\n", replay_path);
+    }
+
+    // Impacts on the ground, to keep the cost of the event stream in the numbers.
+    std::size_t impacts = 0;
+    const GE::EntityType projectiles[] = {GE::EntityType::Ball, GE::EntityType::ThrowingCube, GE::EntityType::Donut};
+    for (auto type : projectiles)
+        WorldPhysics.collisionEvents.setRule(type, GE::EntityType::Ground, {GE::CollisionEvent::Begin, 0.0f});
+    WorldPhysics.collisionEvents.subscribe([&impacts](const GE::CollisionEvent &)
+                                           { ++impacts; });
+
+    std::vector<StepSample> samples;
+    samples.reserve(steps);
+
+    unsigned int spawned = 0;
+    std::size_t ccdArmed = 0, ccdClamped = 0;
+    std::size_t batchedSpheres = 0, batchedBoxes = 0;
+    auto *sphereDispatcher = dynamic_cast<GE::SphereContactDispatcher *>(WorldPhysics.dispatcher);
+    GE::PhysicsStatsLog statsLog;
+    double stageMs[6] = {};
+    if (stats_path && !statsLog.open(stats_path))
+        std::printf("could not write %s\n", stats_path);
+    for (unsigned int s = 0; s < steps; ++s)
+    {
+        // One tick per step, so spawns are keyed to the frame they are added before.
+        if (replay)
+            replay->spawnsAt(WorldPhysics.frame, [&](const GE::RecordedSpawn &r)
+                             { spawned += Launch(WorldPhysics, EntManager, donut, r); });
+        else if (spawn_every && s % spawn_every == 0)
+        {
+            script.spawns.push_back(Script(WorldPhysics.frame, s / spawn_every));
+            spawned += Launch(WorldPhysics, EntManager, donut, script.spawns.back());
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        WorldPhysics.step(FIXED_DT);
+        WorldPhysics.updateBodies();
+        // The entity destructors below print, keep them out of the step time.
+        auto t1 = std::chrono::steady_clock::now();
+        // Events of this tick may still name despawned entities, deliver them first.
+        WorldPhysics.collisionEvents.dispatch();
+        for (const auto &d : WorldPhysics.despawned)
+            EntManager.destroyEntity(d.entity);
+        WorldPhysics.despawned.clear();
+
+        samples.push_back({s,
+                           std::chrono::duration<double, std::milli>(t1 - t0).count(),
+                           WorldPhysics.dynamicsWorld->getNumCollisionObjects(),
+                           WorldPhysics.dispatcher->getNumManifolds(),
+                           WorldPhysics.ccdStats.swept});
+        ccdArmed += WorldPhysics.ccdStats.armed;
+        ccdClamped += WorldPhysics.ccdStats.clamped;
+        if (query_count)
+        {
+            auto q0 = std::chrono::steady_clock::now();
+            WorldPhysics.rayTestBatch(rays, rayHits);
+            WorldPhysics.sweepTestBatch(sweeps, sweepHits);
+            queryMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - q0).count();
+            for (unsigned int i = 0; i < query_count; ++i)
+            {
+                rayHitCount += rayHits[i].entity != nullptr;
+                sweepHitCount += sweepHits[i].entity != nullptr;
+            }
+        }
+        if (particles.size())
+        {
+            auto p0 = std::chrono::steady_clock::now();
+            particles.update(FIXED_DT);
+            particleMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - p0).count();
+        }
+        if (sphereDispatcher)
+        {
+            batchedSpheres += sphereDispatcher->batchedSpheres();
+            batchedBoxes += sphereDispatcher->batchedBoxes();
+        }
+
+        if (statsLog.isOpen())
+        {
+            const GE::PhysicsStats &st = WorldPhysics.stats;
+            statsLog.write(st);
+            stageMs[0] += st.broadphaseMs;
+            stageMs[1] += st.narrowphaseMs;
+            stageMs[2] += st.solverMs;
+            stageMs[3] += st.integrateMs;
+            stageMs[4] += st.ccdMs;
+            stageMs[5] += st.islandsMs;
+        }
+    }
+
+    double total = 0.0, worst = 0.0;
+    for (const auto &sample : samples)
+    {
+        total += sample.ms;
+        worst = sample.ms > worst ? sample.ms : worst;
+    }
+
+    if (csv_path)
+    {
+        std::ofstream csv(csv_path);
+        csv << "step,ms,bodies,manifolds,ccd_swept\n";
+        for (const auto &sample : samples)
+            csv << sample.step << "," << sample.ms << "," << sample.bodies << "," << sample.manifolds << "," << sample.ccdSwept << "\n";
+    }
+
+    std::printf("\nsteps: %u spawned: %u\n", steps, spawned);
+    std::printf("step avg: %.3f ms  max: %.3f ms  total: %.1f ms\n", steps ? total / steps : 0.0, worst, total);
+    if (!samples.empty())
+        std::printf("final bodies: %d  manifolds: %d\n", samples.back().bodies, samples.back().manifolds);
+
+    if (query_count && steps)
+        std::printf("queries: %u rays + %u sweeps per step  avg: %.3f ms  hits: %zu rays %zu sweeps\n",
+                    query_count, query_count, queryMs / steps, rayHitCount, sweepHitCount);
+    if (particle_count && steps)
+        std::printf("particles: %zu of %u left  update avg: %.3f ms\n", particles.size(), particle_count, particleMs / steps);
+    if (sphereDispatcher)
+        std::printf("batched contacts: %zu sphere-sphere  %zu sphere-box pair ticks\n", batchedSpheres, batchedBoxes);
+
+    if (statsLog.isOpen() && steps)
+    {
+        std::size_t ccdSwept = 0;
+        for (const auto &sample : samples)
+            ccdSwept += sample.ccdSwept;
+        std::printf("ccd: %zu sweeps  %zu clamped  of %zu armed body ticks\n", ccdSwept, ccdClamped, ccdArmed);
+        std::printf("stage avg ms: broadphase %.3f  narrowphase %.3f  solver %.3f  integrate %.3f  ccd %.3f  islands %.3f\n",
+                    stageMs[0] / steps, stageMs[1] / steps, stageMs[2] / steps, stageMs[3] / steps, stageMs[4] / steps, stageMs[5] / steps);
+        const GE::PhysicsStats &st = WorldPhysics.stats;
+        std::printf("last step: %d active of %d bodies  %d islands  %d pairs  %d manifolds  %d contacts\n",
+                    st.activeBodies, st.bodies, st.islands, st.overlappingPairs, st.manifolds, st.contacts);
+    }
+
+    if (lod)
+        std::printf("reduced lod bodies: %zu\n", WorldPhysics.lod.reducedCount());
+    std::printf("ground impacts: %zu  dropped events: %zu\n", impacts, WorldPhysics.collisionEvents.dropped());
+
+    if (record_path && script.save(record_path))
+        std::printf("%zu spawns recorded to %s\n", script.spawns.size(), record_path);
+
+    if (save_snapshot && GE::WorldSnapshot::Capture(WorldPhysics, EntManager).save(save_snapshot))
+        std::printf("snapshot saved to %s\n", save_snapshot);
+
+    GE::BodyPool::Stats pool = WorldPhysics.bodies.stats();
+    std::printf("body pool: %zu live  %zu free  %zu slots in %zu slabs\n", pool.live, pool.free, pool.capacity, pool.slabs);
+
+    return 0;
+}
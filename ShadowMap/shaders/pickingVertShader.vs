@@ -1,14 +1,18 @@
 #version 460 core
 
 layout(location = 0) in vec3 vert_pos;
+// Particle instances: centre and radius
+layout(location = 3) in vec4 instance;
 
 out vec4 color;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform bool instanced;
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(vert_pos, 1.0);
+	vec3 pos = instanced ? vert_pos * instance.w + instance.xyz : vert_pos;
+	gl_Position = projection * view * model * vec4(pos, 1.0);
 }
@@ -1,11 +1,15 @@
 #version 460 core
 
 layout (location=0) in vec3 aPos;
+// Particle instances: centre and radius
+layout (location=3) in vec4 aInstance;
 
 uniform mat4    lightSpaceMatrix;
 uniform mat4    model;
+uniform bool    instanced;
 
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    vec3 pos = instanced ? aPos * aInstance.w + aInstance.xyz : aPos;
+    gl_Position = lightSpaceMatrix * model * vec4(pos, 1.0);
 }
\ No newline at end of file
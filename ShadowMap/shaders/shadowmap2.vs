@@ -3,6 +3,8 @@
 layout (location=0) in vec3 aPos;
 layout (location=1) in vec3 aNormal;
 layout (location=2) in vec2 aTexCoords;
+// Particle instances: centre and radius
+layout (location=3) in vec4 aInstance;
 
 out VS_OUT{
     vec3 FragPos;
@@ -15,10 +17,13 @@ uniform mat4    lightSpaceMatrix;
 uniform mat4    model;
 uniform mat4    projection;
 uniform mat4    view;
+uniform bool    instanced;
 
 void main()
 {
-    vs_out.FragPos              = vec3(model * vec4(aPos, 1.0));
+    // Instances are only scaled uniformly, the normal needs no correction for it.
+    vec3 pos                    = instanced ? aPos * aInstance.w + aInstance.xyz : aPos;
+    vs_out.FragPos              = vec3(model * vec4(pos, 1.0));
     vs_out.Normal               = transpose(inverse(mat3(model))) * aNormal;
     vs_out.TexCoords            = aTexCoords;
     vs_out.FragPosLightSpace    = lightSpaceMatrix * vec4(vs_out.FragPos, 1.0);
@@ -0,0 +1,71 @@
+#include "BodyPool.hpp"
+
+#include <new>
+
+GE::BodyPool::BodyPool(std::size_t _slabSize) : slabSize{_slabSize ? _slabSize : 1} {}
+
+GE::BodyPool::~BodyPool()
+{
+    for (auto &slab : slabs)
+        for (std::size_t i = 0; i < slabSize; ++i)
+            if (slab[i].live)
+                destroy(reinterpret_cast<btRigidBody *>(slab[i].body));
+}
+
+void GE::BodyPool::grow()
+{
+    Slot *slab = slabs.emplace_back(new Slot[slabSize]).get();
+    // Link back to front so slots are handed out in address order.
+    for (std::size_t i = slabSize; i-- > 0;)
+    {
+        slab[i].live = false;
+        slab[i].nextFree = freeList;
+        freeList = &slab[i];
+    }
+    freeCount += slabSize;
+}
+
+btRigidBody *GE::BodyPool::create(btScalar mass, btCollisionShape *shape, const btVector3 &inertia, RenderTransforms &transforms, unsigned int renderSlot)
+{
+    if (!freeList)
+        grow();
+
+    Slot *slot = freeList;
+    freeList = slot->nextFree;
+    --freeCount;
+    ++liveCount;
+    slot->live = true;
+
+    RenderMotionState *motionState = new (slot->motionState) RenderMotionState(transforms, renderSlot);
+    btRigidBody::btRigidBodyConstructionInfo ci(mass, motionState, shape, inertia);
+    return new (slot->body) btRigidBody(ci);
+}
+
+void GE::BodyPool::destroy(btRigidBody *body)
+{
+    if (!body)
+        return;
+
+    Slot *slot = reinterpret_cast<Slot *>(body);
+    btMotionState *motionState = body->getMotionState();
+    body->~btRigidBody();
+    if (motionState)
+        motionState->~btMotionState();
+
+    slot->live = false;
+    slot->nextFree = freeList;
+    freeList = slot;
+    --liveCount;
+    ++freeCount;
+}
+
+void GE::BodyPool::reserve(std::size_t count)
+{
+    while (freeCount < count)
+        grow();
+}
+
+GE::BodyPool::Stats GE::BodyPool::stats() const
+{
+    return {liveCount, freeCount, slabs.size() * slabSize, slabs.size()};
+}
@@ -0,0 +1,61 @@
+#ifndef BODYPOOL_HPP
+#define BODYPOOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <btBulletDynamicsCommon.h>
+
+#include "RenderTransforms.hpp"
+
+namespace GE
+{
+    // Slab allocator for rigid bodies. Every slot holds a btRigidBody and the
+    // RenderMotionState it uses, so a spawn costs no heap allocation once the
+    // slabs are warm, and destroy() hands the slot back for the next spawn.
+    struct BodyPool
+    {
+        struct Stats
+        {
+            std::size_t live;
+            std::size_t free;
+            std::size_t capacity;
+            std::size_t slabs;
+        };
+
+        explicit BodyPool(std::size_t slabSize = 256);
+        BodyPool(const BodyPool &) = delete;
+        BodyPool &operator=(const BodyPool &) = delete;
+        ~BodyPool();
+
+        // The body starts at the transform stored in its render slot.
+        btRigidBody *create(btScalar mass, btCollisionShape *shape, const btVector3 &inertia, RenderTransforms &transforms, unsigned int renderSlot);
+        // The body must be removed from the world before it is destroyed.
+        void destroy(btRigidBody *body);
+        // Grows until `count` bodies can be created without allocating.
+        void reserve(std::size_t count);
+
+        Stats stats() const;
+
+    private:
+        struct Slot
+        {
+            // The body has to stay first: destroy() maps a body back to its slot by address.
+            alignas(16) unsigned char body[sizeof(btRigidBody)];
+            alignas(16) unsigned char motionState[sizeof(RenderMotionState)];
+            Slot *nextFree;
+            bool live;
+        };
+
+        std::size_t slabSize;
+        std::vector<std::unique_ptr<Slot[]>> slabs;
+        Slot *freeList = nullptr;
+        std::size_t liveCount = 0;
+        std::size_t freeCount = 0;
+
+        void grow();
+    };
+} // namespace GE
+
+#endif
@@ -0,0 +1,187 @@
+#include "CollisionEvents.hpp"
+
+#include <algorithm>
+
+GE::CollisionEvents *GE::CollisionEvents::instance = nullptr;
+
+GE::CollisionEvents::CollisionEvents(std::size_t capacity) : ring(capacity + 1)
+{
+    // Bullet only has one global hook for each, so the last instance wins.
+    instance = this;
+    gContactStartedCallback = ContactStarted;
+    gContactEndedCallback = ContactEnded;
+}
+
+GE::CollisionEvents::~CollisionEvents()
+{
+    if (instance == this)
+    {
+        instance = nullptr;
+        gContactStartedCallback = nullptr;
+        gContactEndedCallback = nullptr;
+    }
+}
+
+void GE::CollisionEvents::setRule(EntityType a, EntityType b, PairRule rule)
+{
+    rules[static_cast<int>(a)][static_cast<int>(b)] = rule;
+    rules[static_cast<int>(b)][static_cast<int>(a)] = rule;
+}
+
+const GE::CollisionEvents::PairRule &GE::CollisionEvents::getRule(EntityType a, EntityType b) const
+{
+    return rules[static_cast<int>(a)][static_cast<int>(b)];
+}
+
+void GE::CollisionEvents::subscribe(Listener listener, EntityType filter)
+{
+    subscribers.push_back({std::move(listener), filter});
+}
+
+const GE::CollisionEvents::PairRule *GE::CollisionEvents::ruleFor(const btPersistentManifold *manifold, Entity **a, Entity **b) const
+{
+    *a = static_cast<Entity *>(manifold->getBody0()->getUserPointer());
+    *b = static_cast<Entity *>(manifold->getBody1()->getUserPointer());
+    if (!*a || !*b)
+        return nullptr;
+
+    const PairRule &rule = getRule((*a)->getType(), (*b)->getType());
+    return rule.events ? &rule : nullptr;
+}
+
+void GE::CollisionEvents::ContactStarted(btPersistentManifold *const &manifold)
+{
+    if (!instance)
+        return;
+
+    Entity *a, *b;
+    if (!instance->ruleFor(manifold, &a, &b))
+        return;
+
+    std::lock_guard<std::mutex> lock(instance->stagingMutex);
+    instance->started.push_back(manifold);
+}
+
+void GE::CollisionEvents::ContactEnded(btPersistentManifold *const &manifold)
+{
+    if (!instance)
+        return;
+
+    std::lock_guard<std::mutex> lock(instance->stagingMutex);
+
+    // Started and ended within the same tick: nobody has seen it yet.
+    auto &started = instance->started;
+    for (std::size_t i = 0; i < started.size(); ++i)
+    {
+        if (started[i] == manifold)
+        {
+            started[i] = started.back();
+            started.pop_back();
+            return;
+        }
+    }
+
+    auto it = instance->watched.find(manifold);
+    if (it == instance->watched.end())
+        return;
+
+    const Watched &w = it->second;
+    if (w.begun && (w.rule.events & CollisionEvent::End))
+        instance->ended.push_back({CollisionEvent::End, w.a, w.b, 0.0f, btVector3(0, 0, 0), btVector3(0, 0, 0), 0});
+    instance->watched.erase(it);
+}
+
+void GE::CollisionEvents::afterTick(unsigned int frame)
+{
+    std::lock_guard<std::mutex> lock(stagingMutex);
+
+    for (btPersistentManifold *manifold : started)
+    {
+        Entity *a, *b;
+        if (const PairRule *rule = ruleFor(manifold, &a, &b))
+            watched[manifold] = {a, b, *rule, false};
+    }
+    started.clear();
+
+    for (CollisionEvent &event : ended)
+    {
+        event.frame = frame;
+        push(event);
+    }
+    ended.clear();
+
+    for (auto it = watched.begin(); it != watched.end();)
+    {
+        const btPersistentManifold *manifold = it->first;
+        Watched &w = it->second;
+        CollisionEvent::Type type = w.begun ? CollisionEvent::Persist : CollisionEvent::Begin;
+        w.begun = true;
+
+        const int numc = manifold->getNumContacts();
+        if ((w.rule.events & type) && numc > 0)
+        {
+            float impulse = 0.0f;
+            for (int c = 0; c < numc; ++c)
+                impulse += manifold->getContactPoint(c).m_appliedImpulse;
+
+            if (impulse >= w.rule.impulseThreshold)
+            {
+                const btManifoldPoint &pt = manifold->getContactPoint(0);
+                push({type, w.a, w.b, impulse, pt.getPositionWorldOnA(), pt.m_normalWorldOnB, frame});
+            }
+        }
+
+        // Impact only rules have nothing left to report for this pair.
+        if (!(w.rule.events & (CollisionEvent::Persist | CollisionEvent::End)))
+            it = watched.erase(it);
+        else
+            ++it;
+    }
+}
+
+void GE::CollisionEvents::forget(const Entity *entity)
+{
+    std::lock_guard<std::mutex> lock(stagingMutex);
+
+    ended.erase(std::remove_if(ended.begin(), ended.end(), [entity](const CollisionEvent &e)
+                               { return e.a == entity || e.b == entity; }),
+                ended.end());
+    for (auto it = watched.begin(); it != watched.end();)
+    {
+        if (it->second.a == entity || it->second.b == entity)
+            it = watched.erase(it);
+        else
+            ++it;
+    }
+}
+
+void GE::CollisionEvents::push(const CollisionEvent &event)
+{
+    std::size_t h = head.load(std::memory_order_relaxed);
+    std::size_t next = (h + 1) % ring.size();
+    if (next == tail.load(std::memory_order_acquire))
+    {
+        ++droppedCount;
+        return;
+    }
+    ring[h] = event;
+    head.store(next, std::memory_order_release);
+}
+
+void GE::CollisionEvents::dispatch()
+{
+    std::size_t t = tail.load(std::memory_order_relaxed);
+    const std::size_t h = head.load(std::memory_order_acquire);
+
+    while (t != h)
+    {
+        const CollisionEvent &event = ring[t];
+        for (const auto &s : subscribers)
+        {
+            if (s.filter == EntityType::Unknown || event.a->getType() == s.filter || event.b->getType() == s.filter)
+                s.listener(event);
+        }
+        t = (t + 1) % ring.size();
+    }
+    tail.store(t, std::memory_order_release);
+}
@@ -0,0 +1,117 @@
+#ifndef COLLISIONEVENTS_HPP
+#define COLLISIONEVENTS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <btBulletDynamicsCommon.h>
+
+#include "EntityManager.hpp"
+
+namespace GE
+{
+    struct CollisionEvent
+    {
+        enum Type : std::uint8_t
+        {
+            Begin = 1 << 0,
+            Persist = 1 << 1,
+            End = 1 << 2,
+        };
+
+        Type type;
+        Entity *a;
+        Entity *b;
+        float impulse;          // summed over the contact points, 0 for End
+        btVector3 point;        // world position of the first contact on A
+        btVector3 normal;       // on B
+        unsigned int frame;
+    };
+
+    // Turns Bullet's contact started/ended callbacks into a stream of
+    // Begin/Persist/End events. Only pairs with a rule are tracked, so the cost
+    // is proportional to the contacts somebody asked for, not to every manifold
+    // in the world.
+    //
+    // Events are written into a fixed ring buffer on the physics thread after
+    // every tick and handed to the subscribers by dispatch(), which can run on
+    // another thread (single producer, single consumer). When the ring is full
+    // new events are dropped and counted.
+    struct CollisionEvents
+    {
+        struct PairRule
+        {
+            std::uint8_t events = 0;        // CollisionEvent::Type mask
+            float impulseThreshold = 0.0f;  // Begin and Persist below it are not reported
+        };
+
+        using Listener = std::function<void(const CollisionEvent &)>;
+
+        explicit CollisionEvents(std::size_t capacity = 4096);
+        CollisionEvents(const CollisionEvents &) = delete;
+        CollisionEvents &operator=(const CollisionEvents &) = delete;
+        ~CollisionEvents();
+
+        // Symmetric, setRule(Ball, Ground) also covers (Ground, Ball).
+        void setRule(EntityType a, EntityType b, PairRule rule);
+        const PairRule &getRule(EntityType a, EntityType b) const;
+
+        // filter = Unknown: every event, otherwise only events involving that type.
+        void subscribe(Listener listener, EntityType filter = EntityType::Unknown);
+
+        // Physics thread, after every tick.
+        void afterTick(unsigned int frame);
+        // Consumer side: delivers everything queued so far.
+        void dispatch();
+        // Physics thread, once the entity's body left the world: drops what is
+        // still pending for it. Events already in the ring are unaffected.
+        void forget(const Entity *entity);
+
+        std::size_t dropped() const { return droppedCount; }
+        std::size_t tracked() const { return watched.size(); }
+
+    private:
+        struct Watched
+        {
+            Entity *a;
+            Entity *b;
+            PairRule rule;
+            bool begun;
+        };
+
+        struct Subscriber
+        {
+            Listener listener;
+            EntityType filter;
+        };
+
+        static constexpr int TYPES = static_cast<int>(EntityType::Count);
+        PairRule rules[TYPES][TYPES];
+
+        // Bullet calls these from the dispatcher, possibly from worker threads.
+        std::mutex stagingMutex;
+        std::vector<btPersistentManifold *> started;
+        std::vector<CollisionEvent> ended;
+        std::unordered_map<const btPersistentManifold *, Watched> watched;
+
+        std::vector<CollisionEvent> ring;
+        std::atomic<std::size_t> head{0};
+        std::atomic<std::size_t> tail{0};
+        std::atomic<std::size_t> droppedCount{0};
+
+        std::vector<Subscriber> subscribers;
+
+        void push(const CollisionEvent &event);
+        const PairRule *ruleFor(const btPersistentManifold *manifold, Entity **a, Entity **b) const;
+
+        static CollisionEvents *instance;
+        static void ContactStarted(btPersistentManifold *const &manifold);
+        static void ContactEnded(btPersistentManifold *const &manifold);
+    };
+} // namespace GE
+
+#endif
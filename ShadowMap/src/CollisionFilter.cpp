@@ -0,0 +1,103 @@
+#include "CollisionFilter.hpp"
+
+namespace
+{
+    bool IsProjectile(GE::EntityType type)
+    {
+        return type == GE::EntityType::Ball || type == GE::EntityType::ThrowingCube || type == GE::EntityType::Donut;
+    }
+} // namespace
+
+GE::CollisionFilter::CollisionFilter()
+{
+    for (auto &row : rules)
+        for (bool &rule : row)
+            rule = true;
+}
+
+void GE::CollisionFilter::setRule(EntityType a, EntityType b, bool collide)
+{
+    rules[static_cast<int>(a)][static_cast<int>(b)] = collide;
+    rules[static_cast<int>(b)][static_cast<int>(a)] = collide;
+}
+
+bool GE::CollisionFilter::getRule(EntityType a, EntityType b) const
+{
+    return rules[static_cast<int>(a)][static_cast<int>(b)];
+}
+
+void GE::CollisionFilter::setDebris(bool on)
+{
+    debris = on;
+    for (int a = 0; a < TYPES; ++a)
+        for (int b = 0; b < TYPES; ++b)
+            if (IsProjectile(static_cast<EntityType>(a)) && IsProjectile(static_cast<EntityType>(b)))
+                rules[a][b] = !on;
+}
+
+int GE::CollisionFilter::group(EntityType type, bool isStatic) const
+{
+    if (isStatic)
+        return 1 << (FIRST_TYPE_BIT + static_cast<int>(EntityType::Ground)) | btBroadphaseProxy::StaticFilter;
+    return 1 << (FIRST_TYPE_BIT + static_cast<int>(type));
+}
+
+int GE::CollisionFilter::mask(EntityType type, bool isStatic) const
+{
+    int m = btBroadphaseProxy::DefaultFilter;
+    if (!isStatic)
+        m |= btBroadphaseProxy::SensorTrigger;
+    const int t = static_cast<int>(isStatic ? EntityType::Ground : type);
+    for (int other = 0; other < TYPES; ++other)
+        if (rules[t][other])
+            m |= 1 << (FIRST_TYPE_BIT + other);
+    return m;
+}
+
+std::uint64_t GE::CollisionFilter::Key(const Entity &a, const Entity &b)
+{
+    std::uint64_t lo = a.m_id < b.m_id ? a.m_id : b.m_id;
+    std::uint64_t hi = a.m_id < b.m_id ? b.m_id : a.m_id;
+    return hi << 32 | lo;
+}
+
+void GE::CollisionFilter::ignore(const Entity &a, const Entity &b)
+{
+    ignored.insert(Key(a, b));
+}
+
+void GE::CollisionFilter::unignore(const Entity &a, const Entity &b)
+{
+    ignored.erase(Key(a, b));
+}
+
+bool GE::CollisionFilter::ignores(const Entity &a, const Entity &b) const
+{
+    return !ignored.empty() && ignored.count(Key(a, b));
+}
+
+void GE::CollisionFilter::forget(const Entity &entity)
+{
+    if (ignored.empty())
+        return;
+    const std::uint64_t id = entity.m_id;
+    std::erase_if(ignored, [id](std::uint64_t key)
+                  { return (key >> 32) == id || (key & 0xffffffffu) == id; });
+}
+
+bool GE::CollisionFilter::needBroadphaseCollision(btBroadphaseProxy *proxy0, btBroadphaseProxy *proxy1) const
+{
+    // Bullet's own test first, cheapest and enough for almost every pair.
+    if (!(proxy0->m_collisionFilterGroup & proxy1->m_collisionFilterMask) ||
+        !(proxy1->m_collisionFilterGroup & proxy0->m_collisionFilterMask))
+        return false;
+    // Two static bodies never need a pair, as with Bullet's default masks.
+    if (proxy0->m_collisionFilterGroup & proxy1->m_collisionFilterGroup & btBroadphaseProxy::StaticFilter)
+        return false;
+    if (ignored.empty())
+        return true;
+
+    const auto *a = static_cast<const Entity *>(static_cast<btCollisionObject *>(proxy0->m_clientObject)->getUserPointer());
+    const auto *b = static_cast<const Entity *>(static_cast<btCollisionObject *>(proxy1->m_clientObject)->getUserPointer());
+    return !a || !b || !ignores(*a, *b);
+}
@@ -0,0 +1,65 @@
+#ifndef COLLISIONFILTER_HPP
+#define COLLISIONFILTER_HPP
+
+#include <cstdint>
+#include <unordered_set>
+
+#include <btBulletDynamicsCommon.h>
+
+#include "EntityManager.hpp"
+
+namespace GE
+{
+    // Which entity types can touch each other, turned into Bullet collision
+    // groups and masks so that the broadphase never even creates a pair the
+    // table rules out.
+    //
+    // Every type gets a group bit of its own above Bullet's built in filters.
+    // A static body is world geometry whatever its entity type and uses the
+    // Ground bit and row, so debris mode does not drop the static boxes.
+    // Static bodies also carry StaticFilter, which keeps them out of the kill
+    // volume and out of pairs with other static bodies, and dynamic bodies
+    // accept SensorTrigger. DefaultFilter stays in every mask so ray and sweep
+    // queries with the default callback filter still see all bodies.
+    //
+    // Installed as the pair cache's overlap filter, it also drops pairs of
+    // entities put on the ignore list.
+    struct CollisionFilter : btOverlapFilterCallback
+    {
+        CollisionFilter();
+
+        // Symmetric, setRule(Ball, Donut, false) also covers (Donut, Ball).
+        // Bodies already in the world keep their masks until Physics::refilterBodies().
+        void setRule(EntityType a, EntityType b, bool collide);
+        bool getRule(EntityType a, EntityType b) const;
+
+        // Debris mode: projectiles (balls, cubes, donuts) only hit the world,
+        // piles of them no longer cost a pair per touching neighbour.
+        void setDebris(bool on);
+        bool isDebris() const { return debris; }
+
+        int group(EntityType type, bool isStatic) const;
+        int mask(EntityType type, bool isStatic) const;
+
+        // Per entity exceptions on top of the table.
+        void ignore(const Entity &a, const Entity &b);
+        void unignore(const Entity &a, const Entity &b);
+        bool ignores(const Entity &a, const Entity &b) const;
+        // Drops every exception naming the entity, once its body is gone.
+        void forget(const Entity &entity);
+
+        bool needBroadphaseCollision(btBroadphaseProxy *proxy0, btBroadphaseProxy *proxy1) const override;
+
+    private:
+        static constexpr int TYPES = static_cast<int>(EntityType::Count);
+        static constexpr int FIRST_TYPE_BIT = 6;    // after Bullet's CharacterFilter
+
+        bool rules[TYPES][TYPES];
+        bool debris = false;
+        std::unordered_set<std::uint64_t> ignored;
+
+        static std::uint64_t Key(const Entity &a, const Entity &b);
+    };
+} // namespace GE
+
+#endif
@@ -0,0 +1,258 @@
+#include "ConvexDecomposition.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <LinearMath/btConvexHullComputer.h>
+
+namespace
+{
+    constexpr char MAGIC[4] = {'G', 'E', 'C', 'D'};
+    constexpr std::uint32_t VERSION = 2;
+
+    struct Part
+    {
+        std::vector<btVector3> points;
+        btScalar concavity;
+    };
+
+    btVector3 Centroid(const std::vector<btVector3> &points)
+    {
+        btVector3 c(0, 0, 0);
+        for (const btVector3 &p : points)
+            c += p;
+        return c / btScalar(points.size());
+    }
+
+    // Points within `band` of the plane also go to both halves, flattened onto
+    // it: the cut face of each hull then spans the same section of the part.
+    // Returns how many of `points` the emptier side got.
+    std::size_t Split(const std::vector<btVector3> &points, int axis, btScalar at, btScalar band, std::vector<btVector3> &below, std::vector<btVector3> &above)
+    {
+        below.clear();
+        above.clear();
+        std::size_t nBelow = 0;
+        for (const btVector3 &p : points)
+        {
+            nBelow += p[axis] < at;
+            (p[axis] < at ? below : above).push_back(p);
+            if (btFabs(p[axis] - at) <= band)
+            {
+                btVector3 onPlane = p;
+                onPlane[axis] = at;
+                below.push_back(onPlane);
+                above.push_back(onPlane);
+            }
+        }
+        return std::min(nBelow, points.size() - nBelow);
+    }
+} // namespace
+
+btScalar GE::ConvexDecomposition::Concavity(const std::vector<btVector3> &points)
+{
+    if (points.size() < 4)
+        return 0;
+
+    btConvexHullComputer hull;
+    hull.compute(&points[0].getX(), sizeof(btVector3), int(points.size()), 0, 0);
+    if (hull.faces.size() == 0)
+        return 0;
+
+    btVector3 inside(0, 0, 0);
+    for (int v = 0; v < hull.vertices.size(); ++v)
+        inside += hull.vertices[v];
+    inside /= btScalar(hull.vertices.size());
+
+    // Outward face planes; a face's first three vertices are enough.
+    std::vector<btVector3> normals;
+    std::vector<btScalar> offsets;
+    for (int f = 0; f < hull.faces.size(); ++f)
+    {
+        const btConvexHullComputer::Edge *first = &hull.edges[hull.faces[f]];
+        const btConvexHullComputer::Edge *second = first->getNextEdgeOfFace();
+        const btVector3 &a = hull.vertices[first->getSourceVertex()];
+        const btVector3 &b = hull.vertices[second->getSourceVertex()];
+        const btVector3 &c = hull.vertices[second->getTargetVertex()];
+        btVector3 n = (b - a).cross(c - a);
+        if (n.length2() < SIMD_EPSILON)
+            continue;
+        n.normalize();
+        if (n.dot(inside - a) > 0)
+            n = -n;
+        normals.push_back(n);
+        offsets.push_back(n.dot(a));
+    }
+
+    btScalar deepest = 0;
+    for (const btVector3 &p : points)
+    {
+        btScalar depth = BT_LARGE_FLOAT;
+        for (std::size_t i = 0; i < normals.size(); ++i)
+            depth = btMin(depth, offsets[i] - normals[i].dot(p));
+        deepest = btMax(deepest, depth);
+    }
+    return deepest;
+}
+
+GE::ConvexDecomposition GE::ConvexDecomposition::Compute(const float *points, int n_floats, DecompositionParams params)
+{
+    ConvexDecomposition result;
+    result.hash = Hash(points, n_floats, params);
+
+    Part whole;
+    btVector3 lo(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT), hi = -lo;
+    for (int i = 0; i + 2 < n_floats; i += 3)
+    {
+        btVector3 p(points[i], points[i + 1], points[i + 2]);
+        whole.points.push_back(p);
+        lo.setMin(p);
+        hi.setMax(p);
+    }
+    if (whole.points.empty())
+        return result;
+
+    const btScalar threshold = params.maxConcavity * (hi - lo).length();
+    whole.concavity = Concavity(whole.points);
+
+    std::vector<Part> parts;
+    parts.push_back(std::move(whole));
+
+    std::vector<btVector3> below, above;
+    while (int(parts.size()) < params.maxHulls)
+    {
+        auto worst = std::max_element(parts.begin(), parts.end(), [](const Part &a, const Part &b)
+                                      { return a.concavity < b.concavity; });
+        if (worst->concavity <= threshold || int(worst->points.size()) < params.minPoints)
+            break;
+
+        const btVector3 centroid = Centroid(worst->points);
+        btVector3 partLo(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT), partHi = -partLo;
+        for (const btVector3 &p : worst->points)
+        {
+            partLo.setMin(p);
+            partHi.setMax(p);
+        }
+        Part bestBelow, bestAbove;
+        btScalar best = BT_LARGE_FLOAT;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (Split(worst->points, axis, centroid[axis], params.seam * (partHi[axis] - partLo[axis]), below, above) < 4)
+                continue;
+            btScalar cb = Concavity(below), ca = Concavity(above);
+            if (btMax(cb, ca) < best)
+            {
+                best = btMax(cb, ca);
+                bestBelow = {below, cb};
+                bestAbove = {above, ca};
+            }
+        }
+        if (best == BT_LARGE_FLOAT)
+        {
+            // Cannot be split any further, do not pick it again.
+            worst->concavity = 0;
+            continue;
+        }
+
+        *worst = std::move(bestBelow);
+        parts.push_back(std::move(bestAbove));
+    }
+
+    for (Part &part : parts)
+        result.parts.push_back(std::move(part.points));
+    return result;
+}
+
+std::uint64_t GE::ConvexDecomposition::Hash(const float *points, int n_floats, const DecompositionParams &params)
+{
+    // FNV-1a over the raw point data and the parameters that shaped the result.
+    std::uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](const void *data, std::size_t size)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; ++i)
+            h = (h ^ bytes[i]) * 1099511628211ull;
+    };
+    mix(points, sizeof(float) * std::max(n_floats, 0));
+    mix(&params.maxHulls, sizeof(params.maxHulls));
+    mix(&params.maxConcavity, sizeof(params.maxConcavity));
+    mix(&params.minPoints, sizeof(params.minPoints));
+    mix(&params.seam, sizeof(params.seam));
+    return h;
+}
+
+bool GE::ConvexDecomposition::load(const std::string &path, std::uint64_t expectedHash)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+
+    char magic[4];
+    std::uint32_t version, count;
+    std::uint64_t fileHash;
+    in.read(magic, 4);
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    in.read(reinterpret_cast<char *>(&fileHash), sizeof(fileHash));
+    in.read(reinterpret_cast<char *>(&count), sizeof(count));
+    if (!in || std::memcmp(magic, MAGIC, 4) != 0 || version != VERSION || fileHash != expectedHash)
+        return false;
+
+    std::vector<std::vector<btVector3>> loaded(count);
+    for (auto &part : loaded)
+    {
+        std::uint32_t n;
+        in.read(reinterpret_cast<char *>(&n), sizeof(n));
+        if (!in)
+            return false;
+        part.resize(n);
+        for (btVector3 &p : part)
+        {
+            float xyz[3];
+            in.read(reinterpret_cast<char *>(xyz), sizeof(xyz));
+            p.setValue(xyz[0], xyz[1], xyz[2]);
+        }
+    }
+    if (!in)
+        return false;
+
+    parts = std::move(loaded);
+    hash = fileHash;
+    return true;
+}
+
+bool GE::ConvexDecomposition::save(const std::string &path) const
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    std::uint32_t count = parts.size();
+    out.write(MAGIC, 4);
+    out.write(reinterpret_cast<const char *>(&VERSION), sizeof(VERSION));
+    out.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    for (const auto &part : parts)
+    {
+        std::uint32_t n = part.size();
+        out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+        for (const btVector3 &p : part)
+        {
+            float xyz[3] = {float(p.x()), float(p.y()), float(p.z())};
+            out.write(reinterpret_cast<const char *>(xyz), sizeof(xyz));
+        }
+    }
+    return bool(out);
+}
+
+GE::ConvexDecomposition GE::ConvexDecomposition::LoadOrCompute(const std::string &path, const float *points, int n_floats, DecompositionParams params)
+{
+    ConvexDecomposition result;
+    if (result.load(path, Hash(points, n_floats, params)))
+        return result;
+
+    result = Compute(points, n_floats, params);
+    if (!result.save(path))
+        std::printf("could not write convex decomposition cache %s\n", path.c_str());
+    return result;
+}
@@ -0,0 +1,58 @@
+#ifndef CONVEXDECOMPOSITION_HPP
+#define CONVEXDECOMPOSITION_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <btBulletDynamicsCommon.h>
+
+namespace GE
+{
+    struct DecompositionParams
+    {
+        // Upper bound on the number of hulls produced.
+        int maxHulls = 16;
+        // A part is convex enough when no point lies deeper than this inside
+        // its hull, as a fraction of the model's bounding box diagonal.
+        float maxConcavity = 0.03f;
+        // Parts with fewer points are never split.
+        int minPoints = 16;
+        // Points this close to a cutting plane, as a fraction of the part's
+        // extent across it, are also flattened onto the plane and given to
+        // both halves, so that the two hulls meet at the cut.
+        float seam = 0.1f;
+    };
+
+    // Approximate convex decomposition of a point cloud (the vertices of a
+    // concave model), in the spirit of V-HACD but without voxelisation.
+    //
+    // A part's concavity is the deepest any of its points sits inside the
+    // part's exact hull: surface points of a convex part all lie on the hull,
+    // while e.g. the inner ring of a donut lies deep inside it. The most
+    // concave part is split by the axis aligned plane through its centroid
+    // that leaves the least concave halves, until every part is below
+    // maxConcavity or maxHulls is reached. Only vertices are known, not where
+    // the surface crosses the plane, so the halves share the points of a thin
+    // band around it instead, see DecompositionParams::seam.
+    //
+    // Splitting is expensive, so results can be saved next to the model and
+    // are reloaded as long as the points hash to the same value.
+    struct ConvexDecomposition
+    {
+        std::vector<std::vector<btVector3>> parts;
+        std::uint64_t hash = 0;
+
+        static ConvexDecomposition Compute(const float *points, int n_floats, DecompositionParams params = {});
+        // Compute() unless `path` holds a decomposition of the same points; writes it back when it had to compute.
+        static ConvexDecomposition LoadOrCompute(const std::string &path, const float *points, int n_floats, DecompositionParams params = {});
+
+        static std::uint64_t Hash(const float *points, int n_floats, const DecompositionParams &params);
+        static btScalar Concavity(const std::vector<btVector3> &points);
+
+        bool load(const std::string &path, std::uint64_t expectedHash);
+        bool save(const std::string &path) const;
+    };
+} // namespace GE
+
+#endif
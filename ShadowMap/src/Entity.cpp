@@ -14,13 +14,11 @@ Ball::~Ball()
     std::printf("Entity<Ball> ID:%u deleted | ", m_id);
 }
 
-void Ball::updateModelTransform()
+void Ball::updateModelTransform(const btTransform &t)
 {
-    btTransform t = body->getWorldTransform();
     position = {t.getOrigin().getX(), t.getOrigin().getY(), t.getOrigin().getZ()};
     btQuaternion rot = t.getRotation();
     rotation = glm::rotate(glm::mat4(1.0), rot.getAngle(), glm::vec3(rot.getAxis().getX(), rot.getAxis().getY(), rot.getAxis().getZ()));
-    velocity = {body->getLinearVelocity().getX(), body->getLinearVelocity().getY(), body->getLinearVelocity().getX()};
 }
 
 glm::mat4 Ball::getModelTransformationMatrix() const
@@ -32,6 +30,16 @@ glm::mat4 Ball::getModelTransformationMatrix() const
     return translationMatrix * rotation * scaleMatrix;
 }
 
+glm::vec3 Ball::getScale() const
+{
+    return glm::vec3{radius};
+}
+
+GE::EntityType Ball::getType() const
+{
+    return GE::EntityType::Ball;
+}
+
 
 Donut::Donut(glm::vec3 _pos, glm::vec3 _vel, float _radius)
     : velocity{_vel}, radius{_radius}
@@ -45,13 +53,11 @@ Donut::~Donut()
     std::printf("Entity<Donut> ID:%u deleted | ", m_id);
 }
 
-void Donut::updateModelTransform()
+void Donut::updateModelTransform(const btTransform &t)
 {
-    btTransform t = body->getWorldTransform();
     position = {t.getOrigin().getX(), t.getOrigin().getY(), t.getOrigin().getZ()};
     btQuaternion rot = t.getRotation();
     rotation = glm::rotate(glm::mat4(1.0), rot.getAngle(), glm::vec3(rot.getAxis().getX(), rot.getAxis().getY(), rot.getAxis().getZ()));
-    velocity = {body->getLinearVelocity().getX(), body->getLinearVelocity().getY(), body->getLinearVelocity().getX()};
 }
 
 glm::mat4 Donut::getModelTransformationMatrix() const
@@ -63,6 +69,16 @@ glm::mat4 Donut::getModelTransformationMatrix() const
     return translationMatrix * rotation * scaleMatrix;
 }
 
+glm::vec3 Donut::getScale() const
+{
+    return glm::vec3{radius};
+}
+
+GE::EntityType Donut::getType() const
+{
+    return GE::EntityType::Donut;
+}
+
 Ground::Ground(glm::vec3 _position, glm::vec2 _dimensions, glm::mat4 _init_rotation)
     : dimensions{_dimensions}
 {
@@ -76,9 +92,8 @@ Ground::~Ground()
     // std::printf("Entity<Ground> ID:%u deleted | ", m_id);
 }
 
-void Ground::updateModelTransform()
+void Ground::updateModelTransform(const btTransform &t)
 {
-    btTransform t = body->getWorldTransform();
     position = {t.getOrigin().getX(), t.getOrigin().getY(), t.getOrigin().getZ()};
     btQuaternion rot = t.getRotation();
     rotation = glm::rotate(glm::mat4(1.0), rot.getAngle(), glm::vec3(rot.getAxis().getX(), rot.getAxis().getY(), rot.getAxis().getZ()));
@@ -93,6 +108,45 @@ glm::mat4 Ground::getModelTransformationMatrix() const
     return translationMatrix * rotation * scaleMatrix;
 }
 
+glm::vec3 Ground::getScale() const
+{
+    return glm::vec3{dimensions.x, 1.0f, dimensions.y};
+}
+
+GE::EntityType Ground::getType() const
+{
+    return GE::EntityType::Ground;
+}
+
+Terrain::Terrain(glm::vec3 _position)
+{
+    rotation = glm::mat4(1.0f);
+    position = _position;
+    std::printf("Entity<Terrain> ID:%u\n", m_id);
+}
+
+Terrain::~Terrain() {}
+
+void Terrain::updateModelTransform(const btTransform &t)
+{
+    position = {t.getOrigin().getX(), t.getOrigin().getY(), t.getOrigin().getZ()};
+}
+
+glm::mat4 Terrain::getModelTransformationMatrix() const
+{
+    return glm::translate(glm::mat4(1.0), position);
+}
+
+glm::vec3 Terrain::getScale() const
+{
+    return glm::vec3{1.0f};
+}
+
+GE::EntityType Terrain::getType() const
+{
+    return GE::EntityType::Terrain;
+}
+
 ThrowingCube::ThrowingCube(glm::vec3 _pos, glm::vec3 _dim, glm::vec3 _vel, glm::mat4 _init_rotation)
     : velocity{_vel}, dimensions{_dim}
 {
@@ -106,13 +160,11 @@ ThrowingCube::~ThrowingCube()
     std::printf("Entity<ThrowingCube> ID:%u deleted | ", m_id);
 }
 
-void ThrowingCube::updateModelTransform()
+void ThrowingCube::updateModelTransform(const btTransform &t)
 {
-    btTransform t = body->getWorldTransform();
     position = {t.getOrigin().getX(), t.getOrigin().getY(), t.getOrigin().getZ()};
     btQuaternion rot = t.getRotation();
     rotation = glm::rotate(glm::mat4(1.0), rot.getAngle(), glm::vec3(rot.getAxis().getX(), rot.getAxis().getY(), rot.getAxis().getZ()));
-    velocity = {body->getLinearVelocity().getX(), body->getLinearVelocity().getY(), body->getLinearVelocity().getX()};
 }
 
 glm::mat4 ThrowingCube::getModelTransformationMatrix() const
@@ -122,4 +174,14 @@ glm::mat4 ThrowingCube::getModelTransformationMatrix() const
     glm::mat4 scaleMatrix = glm::scale(glm::mat4(1.0), scale);
 
     return translationMatrix * rotation * scaleMatrix;
+}
+
+glm::vec3 ThrowingCube::getScale() const
+{
+    return dimensions;
+}
+
+GE::EntityType ThrowingCube::getType() const
+{
+    return GE::EntityType::ThrowingCube;
 }
\ No newline at end of file
@@ -3,7 +3,6 @@
 
 #include <glm/glm.hpp>
 
-#include "Model.hpp"
 #include "EntityManager.hpp"
 
 struct Ball : public GE::Entity
@@ -12,8 +11,10 @@ struct Ball : public GE::Entity
     Ball(glm::vec3 _pos, glm::vec3 vel, float radius);
     ~Ball() override;
 
-    void updateModelTransform() override;
+    void updateModelTransform(const btTransform &t) override;
     glm::mat4 getModelTransformationMatrix() const override;
+    glm::vec3 getScale() const override;
+    GE::EntityType getType() const override;
 
     glm::vec3 velocity;
     float radius;
@@ -27,19 +28,35 @@ struct Ground : public GE::Entity
     Ground(glm::vec3 _pos, glm::vec2 _dimensions, glm::mat4 _init_rotation = glm::mat4(0));
     ~Ground() override;
 
-    void updateModelTransform() override;
+    void updateModelTransform(const btTransform &t) override;
     glm::mat4 getModelTransformationMatrix() const override;
+    glm::vec3 getScale() const override;
+    GE::EntityType getType() const override;
 
     glm::vec2 dimensions;
 };
 
+// Static heightfield ground, drawn by GE::TerrainMesh rather than through a model.
+struct Terrain : public GE::Entity
+{
+    Terrain(glm::vec3 _pos);
+    ~Terrain() override;
+
+    void updateModelTransform(const btTransform &t) override;
+    glm::mat4 getModelTransformationMatrix() const override;
+    glm::vec3 getScale() const override;
+    GE::EntityType getType() const override;
+};
+
 struct ThrowingCube : public GE::Entity
 {
     ThrowingCube(glm::vec3 _pos, glm::vec3 _dim, glm::vec3 vel, glm::mat4 _init_rotation = glm::mat4(0));
     ~ThrowingCube() override;
 
-    void updateModelTransform() override;
+    void updateModelTransform(const btTransform &t) override;
     glm::mat4 getModelTransformationMatrix() const override;
+    glm::vec3 getScale() const override;
+    GE::EntityType getType() const override;
 
     glm::vec3 velocity;
     glm::vec3 dimensions;
@@ -51,8 +68,10 @@ struct Donut : public GE::Entity
     Donut(glm::vec3 _pos, glm::vec3 vel, float radius);
     ~Donut() override;
 
-    void updateModelTransform() override;
+    void updateModelTransform(const btTransform &t) override;
     glm::mat4 getModelTransformationMatrix() const override;
+    glm::vec3 getScale() const override;
+    GE::EntityType getType() const override;
 
     glm::vec3 velocity;
     float radius;
@@ -10,25 +10,66 @@ GE::EntityManager::~EntityManager()
 {
     for (Entity *e : Entities)
     {
-        delete e;
+        freeEntity(e);
     }
 }
 
-void GE::EntityManager::updateEntities()
+void GE::EntityManager::removeEntity(Entity* e)
+{
+    e->model = nullptr;
+    e->body = nullptr;
+}
+
+void GE::EntityManager::destroyEntity(Entity *e)
+{
+    if (selected == e)
+        selected = nullptr;
+
+    // Order does not matter, fill the hole with the last entity.
+    Entities[e->managerIndex] = Entities.back();
+    Entities[e->managerIndex]->managerIndex = e->managerIndex;
+    Entities.pop_back();
+    freeEntity(e);
+}
+
+void GE::EntityManager::freeEntity(Entity *e)
 {
-    for(Entity* e: Entities)
+    EntityBlock *block = e->block;
+    if (!block)
+    {
+        delete e;
+        return;
+    }
+    e->~Entity();
+    if (--block->live == 0)
     {
-        if(e->position.y < -100.0f)
-        {
-            e->model = nullptr;
-        }
+        ::operator delete(block->storage, block->alignment);
+        delete block;
     }
 }
 
-void GE::EntityManager::removeEntity(Entity* e)
+btTransform GE::InterpolateTransform(const btTransform &from, const btTransform &to, float alpha)
 {
-    e->model = nullptr;
-    e->body = nullptr;
+    if (alpha >= 1.0f)
+        return to;
+
+    btTransform t;
+    t.setOrigin(from.getOrigin().lerp(to.getOrigin(), alpha));
+    t.setRotation(from.getRotation().slerp(to.getRotation(), alpha));
+    return t;
+}
+
+glm::mat4 GE::Entity::getRenderMatrix(float alpha) const
+{
+    return transforms->getModelMatrix(renderSlot, alpha);
+}
+
+void GE::Entity::syncTransform()
+{
+    if (!transforms || !transforms->dirty[renderSlot])
+        return;
+    updateModelTransform(transforms->current[renderSlot]);
+    transforms->dirty[renderSlot] = 0;
 }
 
 const Model *GE::EntityManager::createModel(Model *model)
@@ -2,18 +2,52 @@
 #define ENTITYMANAGER_HPP
 
 #include <vector>
+#include <cstdio>
+#include <new>
+#include <span>
+#include <cstdint>
+#include <type_traits>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-#include "Model.hpp"
+#include <btBulletDynamicsCommon.h>
+
+#include "RenderTransforms.hpp"
+
+// Entities only hold a pointer to their model, so the physics side can be
+// built without pulling in any GL header (see the headless target).
+class Model;
 
 namespace GE
 {
 
+    // Blend of two physics states, alpha = 0 gives `from`, 1 gives `to`
+    btTransform InterpolateTransform(const btTransform &from, const btTransform &to, float alpha);
+
+    // Storage of one EntityManager::createEntities() batch, freed with its last entity.
+    struct EntityBlock
+    {
+        void *storage;
+        std::align_val_t alignment;
+        std::size_t live;
+    };
+
     template <class EntityType, class Entity>
     concept Derived = std::is_base_of_v<Entity, EntityType>;
 
+    // One value per concrete entity, used to configure behaviour per type from tables.
+    enum class EntityType : std::uint8_t
+    {
+        Unknown,
+        Ball,
+        Ground,
+        ThrowingCube,
+        Donut,
+        Terrain,
+        Count
+    };
+
     struct Entity
     {
         Entity() { m_id = id++; };
@@ -36,10 +70,26 @@ namespace GE
         glm::vec3 position;
         glm::mat4 rotation;
 
-        virtual void        updateModelTransform() = 0;
+        // Render slot written by the body's motion state, set up by Physics
+        RenderTransforms *transforms = nullptr;
+        unsigned int renderSlot = 0;
+
+        // Model matrix blended between the last two physics ticks
+        glm::mat4 getRenderMatrix(float alpha) const;
+        // Refresh position/rotation if the body moved since the last call
+        void syncTransform();
+
+        // t: transform to draw with, already interpolated by the caller
+        virtual void        updateModelTransform(const btTransform &t) = 0;
         virtual glm::mat4   getModelTransformationMatrix() const = 0;
+        virtual glm::vec3   getScale() const = 0;
+        virtual EntityType  getType() const { return EntityType::Unknown; }
 
         bool selected = false;
+        // Position in EntityManager::Entities
+        std::size_t managerIndex = 0;
+        // Set when the entity was built in place in a batch block, not with new.
+        EntityBlock *block = nullptr;
     };
 
     struct EntityManager
@@ -52,8 +102,9 @@ namespace GE
         EntityManager(size_t size = 100);
         ~EntityManager();
 
-        void updateEntities();
         void removeEntity(Entity *e);
+        // Deletes the entity; its body has to be gone already (Physics::updateBodies).
+        void destroyEntity(Entity *e);
 
         const Model *createModel(Model *model);
 
@@ -62,9 +113,40 @@ namespace GE
         {
             EntityType *e = new EntityType(vars...);
             e->model = model;
+            e->managerIndex = Entities.size();
             Entities.push_back(e);
             return *e;
         }
+
+        // `count` entities in one go, contiguous in a single block. make(i) returns
+        // the EntityType for index i by value, it is constructed in place.
+        // The span points into Entities and is only valid until the next create.
+        template <Derived<Entity> EntityType, typename Make>
+        std::span<Entity *const> createEntities(const Model *model, std::size_t count, Make make)
+        {
+            const std::size_t first = Entities.size();
+            if (count == 0)
+                return {};
+            Entities.reserve(first + count);
+
+            const std::align_val_t alignment{alignof(EntityType)};
+            EntityBlock *block = new EntityBlock{::operator new(count * sizeof(EntityType), alignment), alignment, 0};
+            EntityType *objects = static_cast<EntityType *>(block->storage);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                EntityType *e = new (objects + i) EntityType(make(i));
+                ++block->live;
+                e->block = block;
+                e->model = model;
+                e->managerIndex = Entities.size();
+                Entities.push_back(e);
+            }
+            return {Entities.data() + first, count};
+        }
+
+    private:
+        // delete, or destruction in place for entities of a block.
+        static void freeEntity(Entity *e);
     };
 } // namespace GE
 
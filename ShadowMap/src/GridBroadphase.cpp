@@ -0,0 +1,291 @@
+#include "GridBroadphase.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <LinearMath/btAabbUtil2.h>
+
+namespace
+{
+    // Drops pairs whose AABBs stopped overlapping.
+    struct RemoveSeparated : public btOverlapCallback
+    {
+        bool processOverlap(btBroadphasePair &pair) override
+        {
+            return !TestAabbAgainstAabb2(pair.m_pProxy0->m_aabbMin, pair.m_pProxy0->m_aabbMax,
+                                         pair.m_pProxy1->m_aabbMin, pair.m_pProxy1->m_aabbMax);
+        }
+    };
+
+    constexpr int RAY_CELL_LIMIT = 4096;
+} // namespace
+
+GE::GridBroadphase::GridBroadphase(const btVector3 &_worldMin, const btVector3 &_worldMax, btScalar _cellSize, int _maxCellsPerProxy)
+    : worldMin{_worldMin}, worldMax{_worldMax}, cellSize{_cellSize}, invCellSize{1 / _cellSize}, maxCellsPerProxy{_maxCellsPerProxy}
+{
+    pairCache = new btHashedOverlappingPairCache();
+}
+
+GE::GridBroadphase::~GridBroadphase()
+{
+    for (Proxy *proxy : proxies)
+        delete proxy;
+    delete pairCache;
+}
+
+std::uint64_t GE::GridBroadphase::CellKey(int x, int y, int z)
+{
+    return (std::uint64_t(x) & 0x1fffff) | (std::uint64_t(y) & 0x1fffff) << 21 | (std::uint64_t(z) & 0x1fffff) << 42;
+}
+
+void GE::GridBroadphase::cellRange(const btVector3 &aabbMin, const btVector3 &aabbMax, int lo[3], int hi[3]) const
+{
+    // Outside the world box everything piles up in the border cells.
+    for (int a = 0; a < 3; ++a)
+    {
+        const btScalar extent = worldMax[a] - worldMin[a];
+        lo[a] = int(btMax(btScalar(0), btMin(extent, aabbMin[a] - worldMin[a])) * invCellSize);
+        hi[a] = int(btMax(btScalar(0), btMin(extent, aabbMax[a] - worldMin[a])) * invCellSize);
+    }
+}
+
+template <class Visit>
+void GE::GridBroadphase::forEachInRange(const int lo[3], const int hi[3], Visit visit)
+{
+    for (int x = lo[0]; x <= hi[0]; ++x)
+        for (int y = lo[1]; y <= hi[1]; ++y)
+            for (int z = lo[2]; z <= hi[2]; ++z)
+            {
+                auto it = cells.find(CellKey(x, y, z));
+                if (it == cells.end())
+                    continue;
+                for (Proxy *proxy : it->second)
+                    visit(proxy);
+            }
+}
+
+template <class Visit>
+void GE::GridBroadphase::forEachUniqueInRange(const int lo[3], const int hi[3], Visit visit) const
+{
+    for (int x = lo[0]; x <= hi[0]; ++x)
+        for (int y = lo[1]; y <= hi[1]; ++y)
+            for (int z = lo[2]; z <= hi[2]; ++z)
+            {
+                auto it = cells.find(CellKey(x, y, z));
+                if (it == cells.end())
+                    continue;
+                for (Proxy *proxy : it->second)
+                    if (x == std::max(lo[0], proxy->lo[0]) && y == std::max(lo[1], proxy->lo[1]) && z == std::max(lo[2], proxy->lo[2]))
+                        visit(proxy);
+            }
+}
+
+void GE::GridBroadphase::insert(Proxy *proxy)
+{
+    cellRange(proxy->m_aabbMin, proxy->m_aabbMax, proxy->lo, proxy->hi);
+    const long count = long(proxy->hi[0] - proxy->lo[0] + 1) * (proxy->hi[1] - proxy->lo[1] + 1) * (proxy->hi[2] - proxy->lo[2] + 1);
+    proxy->large = count > maxCellsPerProxy;
+    if (proxy->large)
+    {
+        large.push_back(proxy);
+        return;
+    }
+
+    for (int x = proxy->lo[0]; x <= proxy->hi[0]; ++x)
+        for (int y = proxy->lo[1]; y <= proxy->hi[1]; ++y)
+            for (int z = proxy->lo[2]; z <= proxy->hi[2]; ++z)
+                cells[CellKey(x, y, z)].push_back(proxy);
+}
+
+void GE::GridBroadphase::remove(Proxy *proxy)
+{
+    auto erase = [proxy](std::vector<Proxy *> &list)
+    {
+        auto it = std::find(list.begin(), list.end(), proxy);
+        if (it == list.end())
+            return;
+        *it = list.back();
+        list.pop_back();
+    };
+
+    if (proxy->large)
+    {
+        erase(large);
+        return;
+    }
+
+    for (int x = proxy->lo[0]; x <= proxy->hi[0]; ++x)
+        for (int y = proxy->lo[1]; y <= proxy->hi[1]; ++y)
+            for (int z = proxy->lo[2]; z <= proxy->hi[2]; ++z)
+            {
+                auto it = cells.find(CellKey(x, y, z));
+                if (it == cells.end())
+                    continue;
+                erase(it->second);
+                if (it->second.empty())
+                    cells.erase(it);
+            }
+}
+
+btBroadphaseProxy *GE::GridBroadphase::createProxy(const btVector3 &aabbMin, const btVector3 &aabbMax, int shapeType, void *userPtr,
+                                                   int collisionFilterGroup, int collisionFilterMask, btDispatcher *dispatcher)
+{
+    Proxy *proxy = new Proxy();
+    proxy->m_aabbMin = aabbMin;
+    proxy->m_aabbMax = aabbMax;
+    proxy->m_clientObject = userPtr;
+    proxy->m_collisionFilterGroup = collisionFilterGroup;
+    proxy->m_collisionFilterMask = collisionFilterMask;
+    // The hashed pair cache keys pairs on this, 0 and 1 are left unused as in Bullet's own broadphases.
+    proxy->m_uniqueId = nextId++;
+    proxy->index = int(proxies.size());
+    proxy->queryStamp = 0;
+    proxies.push_back(proxy);
+
+    insert(proxy);
+    proxy->moved = true;
+    moved.push_back(proxy);
+    return proxy;
+}
+
+void GE::GridBroadphase::destroyProxy(btBroadphaseProxy *base, btDispatcher *dispatcher)
+{
+    Proxy *proxy = static_cast<Proxy *>(base);
+    remove(proxy);
+    pairCache->removeOverlappingPairsContainingProxy(proxy, dispatcher);
+
+    if (proxy->moved)
+        moved.erase(std::find(moved.begin(), moved.end(), proxy));
+
+    proxies[proxy->index] = proxies.back();
+    proxies[proxy->index]->index = proxy->index;
+    proxies.pop_back();
+    delete proxy;
+}
+
+void GE::GridBroadphase::setAabb(btBroadphaseProxy *base, const btVector3 &aabbMin, const btVector3 &aabbMax, btDispatcher *dispatcher)
+{
+    Proxy *proxy = static_cast<Proxy *>(base);
+    if (proxy->m_aabbMin == aabbMin && proxy->m_aabbMax == aabbMax)
+        return;
+
+    proxy->m_aabbMin = aabbMin;
+    proxy->m_aabbMax = aabbMax;
+
+    int lo[3], hi[3];
+    cellRange(aabbMin, aabbMax, lo, hi);
+    if (!std::equal(lo, lo + 3, proxy->lo) || !std::equal(hi, hi + 3, proxy->hi))
+    {
+        remove(proxy);
+        insert(proxy);
+    }
+
+    if (!proxy->moved)
+    {
+        proxy->moved = true;
+        moved.push_back(proxy);
+    }
+}
+
+void GE::GridBroadphase::getAabb(btBroadphaseProxy *proxy, btVector3 &aabbMin, btVector3 &aabbMax) const
+{
+    aabbMin = proxy->m_aabbMin;
+    aabbMax = proxy->m_aabbMax;
+}
+
+void GE::GridBroadphase::calculateOverlappingPairs(btDispatcher *dispatcher)
+{
+    RemoveSeparated separated;
+    pairCache->processAllOverlappingPairs(&separated, dispatcher);
+
+    // addOverlappingPair() returns the existing pair when there is one, so
+    // pairs met twice (both proxies moved) need no special care.
+    auto test = [this](Proxy *p, Proxy *q)
+    {
+        if (p != q && TestAabbAgainstAabb2(p->m_aabbMin, p->m_aabbMax, q->m_aabbMin, q->m_aabbMax))
+            pairCache->addOverlappingPair(p, q);
+    };
+
+    for (Proxy *p : moved)
+    {
+        p->moved = false;
+        if (p->large)
+        {
+            for (Proxy *q : proxies)
+                test(p, q);
+            continue;
+        }
+
+        // 0 is what new proxies start with, so on wrapping around every proxy starts over.
+        if (++stamp == 0)
+        {
+            for (Proxy *q : proxies)
+                q->queryStamp = 0;
+            stamp = 1;
+        }
+        forEachInRange(p->lo, p->hi, [&](Proxy *q)
+                       {
+                           if (q->queryStamp == stamp)
+                               return;
+                           q->queryStamp = stamp;
+                           test(p, q); });
+        for (Proxy *q : large)
+            test(p, q);
+    }
+    moved.clear();
+}
+
+void GE::GridBroadphase::rayTest(const btVector3 &rayFrom, const btVector3 &rayTo, btBroadphaseRayCallback &rayCallback, const btVector3 &aabbMin, const btVector3 &aabbMax)
+{
+    auto visit = [&](Proxy *proxy)
+    {
+        btVector3 bounds[2] = {proxy->m_aabbMin - aabbMax, proxy->m_aabbMax - aabbMin};
+        btScalar param = 0;
+        if (btRayAabb2(rayFrom, rayCallback.m_rayDirectionInverse, rayCallback.m_signs, bounds, param, 0, rayCallback.m_lambda_max))
+            rayCallback.process(proxy);
+    };
+
+    btVector3 rayMin = rayFrom, rayMax = rayFrom;
+    rayMin.setMin(rayTo);
+    rayMax.setMax(rayTo);
+    int lo[3], hi[3];
+    cellRange(rayMin + aabbMin, rayMax + aabbMax, lo, hi);
+    const long count = long(hi[0] - lo[0] + 1) * (hi[1] - lo[1] + 1) * (hi[2] - lo[2] + 1);
+    if (count > RAY_CELL_LIMIT)
+    {
+        for (Proxy *proxy : proxies)
+            visit(proxy);
+        return;
+    }
+
+    forEachUniqueInRange(lo, hi, visit);
+    for (Proxy *proxy : large)
+        visit(proxy);
+}
+
+void GE::GridBroadphase::aabbTest(const btVector3 &aabbMin, const btVector3 &aabbMax, btBroadphaseAabbCallback &callback)
+{
+    auto visit = [&](Proxy *proxy)
+    {
+        if (TestAabbAgainstAabb2(aabbMin, aabbMax, proxy->m_aabbMin, proxy->m_aabbMax))
+            callback.process(proxy);
+    };
+
+    int lo[3], hi[3];
+    cellRange(aabbMin, aabbMax, lo, hi);
+    forEachUniqueInRange(lo, hi, visit);
+    for (Proxy *proxy : large)
+        visit(proxy);
+}
+
+void GE::GridBroadphase::getBroadphaseAabb(btVector3 &aabbMin, btVector3 &aabbMax) const
+{
+    aabbMin = worldMin;
+    aabbMax = worldMax;
+}
+
+void GE::GridBroadphase::printStats()
+{
+    std::printf("grid broadphase: %zu proxies (%zu large) in %zu cells of %.2f, %d pairs\n",
+                proxies.size(), large.size(), cells.size(), float(cellSize), pairCache->getNumOverlappingPairs());
+}
@@ -0,0 +1,84 @@
+#ifndef GRIDBROADPHASE_HPP
+#define GRIDBROADPHASE_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <btBulletDynamicsCommon.h>
+
+namespace GE
+{
+    // Uniform grid broadphase for a bounded world full of similarly sized bodies.
+    //
+    // Every proxy is registered in the cells its AABB touches. Pairs are only
+    // looked for around proxies whose AABB changed since the last call, so the
+    // cost follows the moving bodies; stale pairs are dropped in one pass over
+    // the pair cache. Proxies spanning more than `maxCellsPerProxy` cells (the
+    // ground, walls) go to a separate list tested against every moved proxy,
+    // which keeps them from bloating the cells.
+    //
+    // Ray queries walk the cells under the ray's AABB when that is small, and
+    // fall back to testing every proxy otherwise. Ray and AABB queries write
+    // nothing, so several threads can run them at once between steps.
+    struct GridBroadphase : public btBroadphaseInterface
+    {
+        GridBroadphase(const btVector3 &worldMin, const btVector3 &worldMax, btScalar cellSize, int maxCellsPerProxy = 64);
+        ~GridBroadphase() override;
+
+        btBroadphaseProxy *createProxy(const btVector3 &aabbMin, const btVector3 &aabbMax, int shapeType, void *userPtr,
+                                       int collisionFilterGroup, int collisionFilterMask, btDispatcher *dispatcher) override;
+        void destroyProxy(btBroadphaseProxy *proxy, btDispatcher *dispatcher) override;
+        void setAabb(btBroadphaseProxy *proxy, const btVector3 &aabbMin, const btVector3 &aabbMax, btDispatcher *dispatcher) override;
+        void getAabb(btBroadphaseProxy *proxy, btVector3 &aabbMin, btVector3 &aabbMax) const override;
+
+        void rayTest(const btVector3 &rayFrom, const btVector3 &rayTo, btBroadphaseRayCallback &rayCallback,
+                     const btVector3 &aabbMin = btVector3(0, 0, 0), const btVector3 &aabbMax = btVector3(0, 0, 0)) override;
+        void aabbTest(const btVector3 &aabbMin, const btVector3 &aabbMax, btBroadphaseAabbCallback &callback) override;
+
+        void calculateOverlappingPairs(btDispatcher *dispatcher) override;
+
+        btOverlappingPairCache *getOverlappingPairCache() override { return pairCache; }
+        const btOverlappingPairCache *getOverlappingPairCache() const override { return pairCache; }
+
+        void getBroadphaseAabb(btVector3 &aabbMin, btVector3 &aabbMax) const override;
+        void printStats() override;
+
+        std::size_t occupiedCells() const { return cells.size(); }
+
+    private:
+        struct Proxy : public btBroadphaseProxy
+        {
+            int lo[3], hi[3];       // cell range, inclusive
+            bool large;
+            bool moved;
+            int index;              // in `proxies`
+            std::uint32_t queryStamp;
+        };
+
+        btOverlappingPairCache *pairCache;
+        btVector3 worldMin, worldMax;
+        btScalar cellSize, invCellSize;
+        int maxCellsPerProxy;
+        std::uint32_t stamp = 0;
+        int nextId = 2;
+
+        std::vector<Proxy *> proxies;
+        std::vector<Proxy *> large;
+        std::vector<Proxy *> moved;
+        std::unordered_map<std::uint64_t, std::vector<Proxy *>> cells;
+
+        void cellRange(const btVector3 &aabbMin, const btVector3 &aabbMax, int lo[3], int hi[3]) const;
+        static std::uint64_t CellKey(int x, int y, int z);
+        void insert(Proxy *proxy);
+        void remove(Proxy *proxy);
+        template <class Visit>
+        void forEachInRange(const int lo[3], const int hi[3], Visit visit);
+        // Every proxy once, without stamps: a proxy is reported by the first
+        // cell it shares with the range.
+        template <class Visit>
+        void forEachUniqueInRange(const int lo[3], const int hi[3], Visit visit) const;
+    };
+} // namespace GE
+
+#endif
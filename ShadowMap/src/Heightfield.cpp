@@ -0,0 +1,81 @@
+#include "Heightfield.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+GE::Heightfield GE::Heightfield::FromPixels(const unsigned char *pixels, int width, int length, int channels, float spacing, float heightScale, int smoothing)
+{
+    Heightfield field;
+    field.width = width;
+    field.length = length;
+    field.spacing = spacing;
+    field.heights.resize(static_cast<std::size_t>(width) * length);
+
+    for (int i = 0; i < width * length; ++i)
+        field.heights[i] = pixels[i * channels] * (heightScale / 255.0f);
+
+    // Separable box filter, one pass along x and one along z.
+    if (smoothing > 0)
+    {
+        std::vector<float> tmp(field.heights.size());
+        for (int z = 0; z < length; ++z)
+            for (int x = 0; x < width; ++x)
+            {
+                float sum = 0.0f;
+                int n = 0;
+                for (int k = std::max(0, x - smoothing); k <= std::min(width - 1, x + smoothing); ++k, ++n)
+                    sum += field.heights[z * width + k];
+                tmp[z * width + x] = sum / n;
+            }
+        for (int z = 0; z < length; ++z)
+            for (int x = 0; x < width; ++x)
+            {
+                float sum = 0.0f;
+                int n = 0;
+                for (int k = std::max(0, z - smoothing); k <= std::min(length - 1, z + smoothing); ++k, ++n)
+                    sum += tmp[k * width + x];
+                field.heights[z * width + x] = sum / n;
+            }
+    }
+
+    auto [lo, hi] = std::minmax_element(field.heights.begin(), field.heights.end());
+    field.minHeight = *lo;
+    field.maxHeight = *hi;
+    return field;
+}
+
+glm::vec3 GE::Heightfield::position(int x, int z) const
+{
+    return {(x - 0.5f * (width - 1)) * spacing, at(x, z), (z - 0.5f * (length - 1)) * spacing};
+}
+
+glm::vec3 GE::Heightfield::normal(int x, int z) const
+{
+    // Central differences, one sided on the edges.
+    int x0 = std::max(x - 1, 0), x1 = std::min(x + 1, width - 1);
+    int z0 = std::max(z - 1, 0), z1 = std::min(z + 1, length - 1);
+    float dx = (at(x1, z) - at(x0, z)) / ((x1 - x0) * spacing);
+    float dz = (at(x, z1) - at(x, z0)) / ((z1 - z0) * spacing);
+    return glm::normalize(glm::vec3{-dx, 1.0f, -dz});
+}
+
+float GE::Heightfield::heightAt(float x, float z) const
+{
+    float fx = std::clamp(x / spacing + 0.5f * (width - 1), 0.0f, width - 1.0f);
+    float fz = std::clamp(z / spacing + 0.5f * (length - 1), 0.0f, length - 1.0f);
+    int x0 = std::min(static_cast<int>(fx), width - 2), z0 = std::min(static_cast<int>(fz), length - 2);
+    float tx = fx - x0, tz = fz - z0;
+    float h0 = at(x0, z0) + (at(x0 + 1, z0) - at(x0, z0)) * tx;
+    float h1 = at(x0, z0 + 1) + (at(x0 + 1, z0 + 1) - at(x0, z0 + 1)) * tx;
+    return h0 + (h1 - h0) * tz;
+}
+
+btHeightfieldTerrainShape *GE::Heightfield::getShape()
+{
+    if (!shape)
+    {
+        shape = std::make_unique<btHeightfieldTerrainShape>(width, length, heights.data(), 1.0f, minHeight, maxHeight, 1, PHY_FLOAT, false);
+        shape->setLocalScaling(btVector3(spacing, 1.0f, spacing));
+    }
+    return shape.get();
+}
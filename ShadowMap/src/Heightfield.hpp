@@ -0,0 +1,55 @@
+#ifndef HEIGHTFIELD_HPP
+#define HEIGHTFIELD_HPP
+
+#include <memory>
+#include <vector>
+
+#include <btBulletDynamicsCommon.h>
+#include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+#include <glm/glm.hpp>
+
+namespace GE
+{
+    // Grid of terrain heights, `spacing` apart on x and z, and the Bullet shape
+    // that collides against it.
+    //
+    // btHeightfieldTerrainShape reads the heights in place and only builds the
+    // triangles a query touches, so a 1024x1024 terrain costs 4 MB of floats
+    // instead of two million stored triangles and their BVH.
+    //
+    // The grid is centred on its origin: sample (x, z) sits at position(x, z).
+    // The shape keeps a pointer into `heights`, so the Heightfield has to
+    // outlive every body using it.
+    struct Heightfield
+    {
+        Heightfield() = default;
+        Heightfield(Heightfield &&) = default;
+        Heightfield &operator=(Heightfield &&) = default;
+
+        // `pixels` holds `length` rows of `width` texels of `channels` bytes, the
+        // first channel is the height: 0 -> 0, 255 -> heightScale. `smoothing`
+        // is the radius of a box filter, image noise makes for a very rough terrain.
+        static Heightfield FromPixels(const unsigned char *pixels, int width, int length, int channels, float spacing, float heightScale, int smoothing = 0);
+
+        int width = 0;      // samples along x
+        int length = 0;     // samples along z
+        float spacing = 1.0f;
+        float minHeight = 0.0f;
+        float maxHeight = 0.0f;
+        std::vector<float> heights;     // row major, x fastest
+
+        float at(int x, int z) const { return heights[z * width + x]; }
+        glm::vec3 position(int x, int z) const;
+        glm::vec3 normal(int x, int z) const;
+        // Bilinear height at local (x, z), clamped to the edges.
+        float heightAt(float x, float z) const;
+
+        // Built on first use, owned by the Heightfield.
+        btHeightfieldTerrainShape *getShape();
+
+    private:
+        std::unique_ptr<btHeightfieldTerrainShape> shape;
+    };
+} // namespace GE
+
+#endif
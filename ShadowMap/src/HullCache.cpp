@@ -0,0 +1,301 @@
+#include "HullCache.hpp"
+
+#include <BulletCollision/CollisionShapes/btShapeHull.h>
+
+GE::HullCache::HullCache(ShapeCache *_disk) : disk{_disk} {}
+
+GE::HullCache::~HullCache()
+{
+    for (auto &[key, hull] : hulls)
+    {
+        if (btCompoundShape *compound = dynamic_cast<btCompoundShape *>(hull.shape))
+            for (int i = 0; i < compound->getNumChildShapes(); ++i)
+                delete compound->getChildShape(i);
+        delete hull.shape;
+    }
+}
+
+const GE::HullCache::Hull &GE::HullCache::get(const std::string &key, const float *points, int n_floats)
+{
+    auto it = hulls.find(key);
+    if (it != hulls.end())
+        return it->second;
+
+    const std::uint64_t hash = ShapeCache::Hash(points, sizeof(float) * n_floats);
+    Hull hull;
+    if (!load(key, hash, ShapeCache::Kind::Hull, hull))
+    {
+        hull = Cook(points, n_floats);
+        save(key, hash, ShapeCache::Kind::Hull, hull);
+    }
+    return hulls.emplace(key, hull).first->second;
+}
+
+const GE::HullCache::Hull &GE::HullCache::getCompound(const std::string &key, const float *points, int n_floats, const std::string &decompositionPath, DecompositionParams params)
+{
+    auto it = hulls.find(key);
+    if (it != hulls.end())
+        return it->second;
+
+    const std::uint64_t hash = ConvexDecomposition::Hash(points, n_floats, params);
+    Hull hull;
+    if (!load(key, hash, ShapeCache::Kind::Compound, hull))
+    {
+        hull = CookCompound(ConvexDecomposition::LoadOrCompute(decompositionPath, points, n_floats, params));
+        save(key, hash, ShapeCache::Kind::Compound, hull);
+    }
+    return hulls.emplace(key, hull).first->second;
+}
+
+const GE::HullCache::Hull *GE::HullCache::find(const std::string &key) const
+{
+    auto it = hulls.find(key);
+    return it != hulls.end() ? &it->second : nullptr;
+}
+
+bool GE::HullCache::owns(const btCollisionShape *shape) const
+{
+    for (const auto &[key, hull] : hulls)
+        if (hull.shape == shape)
+            return true;
+    return false;
+}
+
+// Volume, centre of mass and inertia of a closed triangle mesh, integrated
+// over the signed tetrahedra the triangles form with the origin
+// (D. Eberly, "Polyhedral Mass Properties").
+static void MassProperties(const btVector3 *v, const unsigned int *indices, int n_indices, GE::HullCache::Hull &hull)
+{
+    btScalar in[10] = {};
+    for (int t = 0; t + 2 < n_indices; t += 3)
+    {
+        const btVector3 &p0 = v[indices[t]];
+        const btVector3 &p1 = v[indices[t + 1]];
+        const btVector3 &p2 = v[indices[t + 2]];
+        const btVector3 d = (p1 - p0).cross(p2 - p0);
+
+        btScalar f1[3], f2[3], f3[3], g0[3], g1[3], g2[3];
+        for (int a = 0; a < 3; ++a)
+        {
+            const btScalar w0 = p0[a], w1 = p1[a], w2 = p2[a];
+            const btScalar t0 = w0 + w1;
+            const btScalar t1 = w0 * w0;
+            const btScalar t2 = t1 + w1 * t0;
+            f1[a] = t0 + w2;
+            f2[a] = t2 + w2 * f1[a];
+            f3[a] = w0 * t1 + w1 * t2 + w2 * f2[a];
+            g0[a] = f2[a] + w0 * (f1[a] + w0);
+            g1[a] = f2[a] + w1 * (f1[a] + w1);
+            g2[a] = f2[a] + w2 * (f1[a] + w2);
+        }
+
+        in[0] += d.x() * f1[0];
+        in[1] += d.x() * f2[0];
+        in[2] += d.y() * f2[1];
+        in[3] += d.z() * f2[2];
+        in[4] += d.x() * f3[0];
+        in[5] += d.y() * f3[1];
+        in[6] += d.z() * f3[2];
+        in[7] += d.x() * (p0.y() * g0[0] + p1.y() * g1[0] + p2.y() * g2[0]);
+        in[8] += d.y() * (p0.z() * g0[1] + p1.z() * g1[1] + p2.z() * g2[1]);
+        in[9] += d.z() * (p0.x() * g0[2] + p1.x() * g1[2] + p2.x() * g2[2]);
+    }
+
+    // The winding btShapeHull produces is not guaranteed, flip inward meshes.
+    const btScalar sign = in[0] < 0 ? -1 : 1;
+    const btScalar volume = sign * in[0] / 6;
+    if (volume <= SIMD_EPSILON)
+        return;
+
+    const btScalar firstOrder = sign / 24, secondOrder = sign / 60;
+    btVector3 cm(in[1] * firstOrder, in[2] * firstOrder, in[3] * firstOrder);
+    cm /= volume;
+
+    const btScalar xx = in[4] * secondOrder, yy = in[5] * secondOrder, zz = in[6] * secondOrder;
+    hull.volume = volume;
+    hull.centerOfMass = cm;
+    // Bullet turns a body about its shape origin, so the inertia is taken
+    // about the origin too, not about cm. Products of inertia (in[7..9]) are
+    // dropped, Bullet only takes the diagonal.
+    hull.unitInertia = btVector3(yy + zz, zz + xx, xx + yy) / volume;
+}
+
+static GE::HullCache::Hull CookRaw(btConvexHullShape &raw, int rawVertices)
+{
+    raw.recalcLocalAabb();
+
+    btShapeHull simplified(&raw);
+    simplified.buildHull(raw.getMargin());
+
+    GE::HullCache::Hull hull;
+    btConvexHullShape *shape = new btConvexHullShape(&simplified.getVertexPointer()->getX(), simplified.numVertices(), sizeof(btVector3));
+    hull.shape = shape;
+    hull.rawVertices = rawVertices;
+
+    // Fallback for degenerate (flat) input: the bounding sphere the bodies used before.
+    btScalar r;
+    shape->getBoundingSphere(hull.centerOfMass, r);
+    const btVector3 &c = hull.centerOfMass;
+    hull.volume = 4.0f / 3.0f * SIMD_PI * r * r * r;
+    hull.unitInertia = btVector3(0.4f * r * r + c.y() * c.y() + c.z() * c.z(),
+                                 0.4f * r * r + c.z() * c.z() + c.x() * c.x(),
+                                 0.4f * r * r + c.x() * c.x() + c.y() * c.y());
+
+    MassProperties(simplified.getVertexPointer(), simplified.getIndexPointer(), simplified.numIndices(), hull);
+    return hull;
+}
+
+GE::HullCache::Hull GE::HullCache::Cook(const float *points, int n_floats)
+{
+    btConvexHullShape raw;
+    for (int i = 0; i + 2 < n_floats; i += 3)
+        raw.addPoint(btVector3(points[i], points[i + 1], points[i + 2]), false);
+    return CookRaw(raw, n_floats / 3);
+}
+
+GE::HullCache::Hull GE::HullCache::Cook(const std::vector<btVector3> &points)
+{
+    btConvexHullShape raw;
+    for (const btVector3 &p : points)
+        raw.addPoint(p, false);
+    return CookRaw(raw, int(points.size()));
+}
+
+GE::HullCache::Hull GE::HullCache::CookCompound(const ConvexDecomposition &decomposition)
+{
+    btCompoundShape *compound = new btCompoundShape(true, int(decomposition.parts.size()));
+    std::vector<Hull> parts;
+    for (const auto &points : decomposition.parts)
+    {
+        parts.push_back(Cook(points));
+        btTransform identity;
+        identity.setIdentity();
+        compound->addChildShape(identity, parts.back().shape);
+    }
+
+    // Every part sits at the compound's origin and has its inertia about it,
+    // so the compound's is their volume weighted sum.
+    Hull hull{compound, 0, btVector3(0, 0, 0), btVector3(0, 0, 0), 0};
+    for (const Hull &part : parts)
+    {
+        hull.volume += part.volume;
+        hull.centerOfMass += part.centerOfMass * part.volume;
+        hull.unitInertia += part.unitInertia * part.volume;
+        hull.rawVertices += part.rawVertices;
+    }
+    if (hull.volume <= SIMD_EPSILON)
+        return hull;
+    hull.centerOfMass /= hull.volume;
+    hull.unitInertia /= hull.volume;
+    return hull;
+}
+
+// On disk a convex hull is its mass properties followed by the simplified
+// points; a compound is the combined properties followed by one such record
+// per child. Children sit at the compound's origin.
+static void WriteProperties(GE::ShapeCache::Writer &w, const GE::HullCache::Hull &hull)
+{
+    w.put(float(hull.volume));
+    for (int a = 0; a < 3; ++a)
+        w.put(float(hull.centerOfMass[a]));
+    for (int a = 0; a < 3; ++a)
+        w.put(float(hull.unitInertia[a]));
+    w.put(std::int32_t(hull.rawVertices));
+}
+
+static bool ReadProperties(GE::ShapeCache::Reader &r, GE::HullCache::Hull &hull)
+{
+    float v[7];
+    std::int32_t raw;
+    for (float &f : v)
+        if (!r.get(f))
+            return false;
+    if (!r.get(raw))
+        return false;
+    hull.volume = v[0];
+    hull.centerOfMass = btVector3(v[1], v[2], v[3]);
+    hull.unitInertia = btVector3(v[4], v[5], v[6]);
+    hull.rawVertices = raw;
+    return true;
+}
+
+static void WriteHull(GE::ShapeCache::Writer &w, const GE::HullCache::Hull &hull)
+{
+    const btConvexHullShape *shape = static_cast<const btConvexHullShape *>(hull.shape);
+    WriteProperties(w, hull);
+    w.put(std::uint32_t(shape->getNumPoints()));
+    for (int i = 0; i < shape->getNumPoints(); ++i)
+        for (int a = 0; a < 3; ++a)
+            w.put(float(shape->getUnscaledPoints()[i][a]));
+}
+
+static bool ReadHull(GE::ShapeCache::Reader &r, GE::HullCache::Hull &hull)
+{
+    std::uint32_t n;
+    if (!ReadProperties(r, hull) || !r.get(n))
+        return false;
+    const char *points = r.skip(n * 3 * sizeof(float));
+    if (!points)
+        return false;
+    hull.shape = new btConvexHullShape(reinterpret_cast<const btScalar *>(points), n, 3 * sizeof(float));
+    return true;
+}
+
+bool GE::HullCache::load(const std::string &key, std::uint64_t hash, ShapeCache::Kind kind, Hull &hull)
+{
+    std::size_t size;
+    const char *payload = disk ? disk->map(key, hash, kind, size) : nullptr;
+    if (!payload)
+        return false;
+
+    ShapeCache::Reader r{payload, size};
+    bool ok;
+    if (kind == ShapeCache::Kind::Hull)
+        ok = ReadHull(r, hull);
+    else
+    {
+        std::uint32_t parts = 0;
+        ok = r.get(parts) && ReadProperties(r, hull);
+        btCompoundShape *compound = new btCompoundShape(true, int(parts));
+        btTransform identity;
+        identity.setIdentity();
+        for (std::uint32_t i = 0; ok && i < parts; ++i)
+        {
+            Hull part;
+            ok = ReadHull(r, part);
+            if (ok)
+                compound->addChildShape(identity, part.shape);
+        }
+        if (!ok)
+        {
+            for (int i = 0; i < compound->getNumChildShapes(); ++i)
+                delete compound->getChildShape(i);
+            delete compound;
+        }
+        else
+            hull.shape = compound;
+    }
+
+    disk->unmap(payload);
+    return ok;
+}
+
+void GE::HullCache::save(const std::string &key, std::uint64_t hash, ShapeCache::Kind kind, const Hull &hull)
+{
+    if (!disk || !disk->enabled())
+        return;
+
+    ShapeCache::Writer w;
+    if (kind == ShapeCache::Kind::Hull)
+        WriteHull(w, hull);
+    else
+    {
+        // Child mass properties are not kept once combined, only the shape matters for them.
+        const btCompoundShape *compound = static_cast<const btCompoundShape *>(hull.shape);
+        w.put(std::uint32_t(compound->getNumChildShapes()));
+        WriteProperties(w, hull);
+        for (int i = 0; i < compound->getNumChildShapes(); ++i)
+            WriteHull(w, {const_cast<btCollisionShape *>(compound->getChildShape(i)), 0, btVector3(0, 0, 0), btVector3(0, 0, 0), 0});
+    }
+    disk->store(key, hash, kind, w.bytes);
+}
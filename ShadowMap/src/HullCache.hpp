@@ -0,0 +1,68 @@
+#ifndef HULLCACHE_HPP
+#define HULLCACHE_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <btBulletDynamicsCommon.h>
+
+#include "ConvexDecomposition.hpp"
+#include "ShapeCache.hpp"
+
+namespace GE
+{
+    // Cooks model vertices into small convex hulls, once per model.
+    //
+    // Raw hitbox models have thousands of vertices and the cost of every
+    // support query grows with them. The raw hull is resampled with
+    // btShapeHull, which keeps only the vertices that are extreme along a fixed
+    // set of directions (a few dozen at most), and the mass properties are
+    // integrated over the simplified hull so mass and inertia match the shape
+    // that is actually simulated.
+    //
+    // Concave models can instead be cooked from a ConvexDecomposition into a
+    // btCompoundShape with one simplified hull per part.
+    //
+    // With a ShapeCache, cooked hulls are also written to disk and later runs
+    // load them instead of cooking (or decomposing) again.
+    struct HullCache
+    {
+        struct Hull
+        {
+            btCollisionShape *shape;   // btConvexHullShape, or btCompoundShape of them
+            btScalar volume;
+            btVector3 centerOfMass;     // hull space, bodies still turn about the shape origin
+            btVector3 unitInertia;      // diagonal inertia for mass 1, about the shape origin
+            int rawVertices;
+        };
+
+        explicit HullCache(ShapeCache *disk = nullptr);
+        HullCache(const HullCache &) = delete;
+        HullCache &operator=(const HullCache &) = delete;
+        ~HullCache();
+
+        // `points` holds n_floats / 3 xyz triples. Cooked on the first call for a key.
+        const Hull &get(const std::string &key, const float *points, int n_floats);
+        // Compound of the points' convex decomposition, which is itself cached in
+        // `decompositionPath`. Cooked on the first call for a key.
+        const Hull &getCompound(const std::string &key, const float *points, int n_floats, const std::string &decompositionPath, DecompositionParams params = {});
+        const Hull *find(const std::string &key) const;
+        bool owns(const btCollisionShape *shape) const;
+
+        std::size_t size() const { return hulls.size(); }
+
+        static Hull Cook(const float *points, int n_floats);
+        static Hull Cook(const std::vector<btVector3> &points);
+        static Hull CookCompound(const ConvexDecomposition &decomposition);
+
+    private:
+        ShapeCache *disk;
+        std::unordered_map<std::string, Hull> hulls;
+
+        bool load(const std::string &key, std::uint64_t hash, ShapeCache::Kind kind, Hull &hull);
+        void save(const std::string &key, std::uint64_t hash, ShapeCache::Kind kind, const Hull &hull);
+    };
+} // namespace GE
+
+#endif
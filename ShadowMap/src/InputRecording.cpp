@@ -0,0 +1,119 @@
+#include "InputRecording.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+bool GE::InputRecording::save(const std::string &path) const
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+        return false;
+
+    // Exact round trip of every float.
+    out.precision(9);
+    for (const RecordedSpawn &s : spawns)
+    {
+        out << "spawn " << s.frame << ' ' << static_cast<int>(s.type);
+        for (const glm::vec3 &v : {s.size, s.position, s.velocity})
+            out << ' ' << v.x << ' ' << v.y << ' ' << v.z;
+        for (int c = 0; c < 3; ++c)
+            for (int r = 0; r < 3; ++r)
+                out << ' ' << s.rotation[c][r];
+        out << '\n';
+    }
+    for (const RecordedCamera &c : cameras)
+        out << "camera " << c.frame << ' ' << c.position.x << ' ' << c.position.y << ' ' << c.position.z << ' ' << c.yaw << ' ' << c.pitch << '\n';
+    return bool(out);
+}
+
+bool GE::InputRecording::load(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+
+    spawns.clear();
+    cameras.clear();
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream ss(line);
+        std::string kind;
+        ss >> kind;
+        if (kind == "spawn")
+        {
+            RecordedSpawn s{};
+            int type;
+            ss >> s.frame >> type;
+            for (glm::vec3 *v : {&s.size, &s.position, &s.velocity})
+                ss >> v->x >> v->y >> v->z;
+            s.rotation = glm::mat4(1.0f);
+            for (int c = 0; c < 3; ++c)
+                for (int r = 0; r < 3; ++r)
+                    ss >> s.rotation[c][r];
+            s.type = static_cast<EntityType>(type);
+            if (ss)
+                spawns.push_back(s);
+        }
+        else if (kind == "camera")
+        {
+            RecordedCamera c{};
+            ss >> c.frame >> c.position.x >> c.position.y >> c.position.z >> c.yaw >> c.pitch;
+            if (ss)
+                cameras.push_back(c);
+        }
+    }
+
+    auto byFrame = [](const auto &a, const auto &b)
+    { return a.frame < b.frame; };
+    std::stable_sort(spawns.begin(), spawns.end(), byFrame);
+    std::stable_sort(cameras.begin(), cameras.end(), byFrame);
+    return true;
+}
+
+unsigned int GE::InputRecording::lastFrame() const
+{
+    unsigned int last = 0;
+    if (!spawns.empty())
+        last = std::max(last, spawns.back().frame);
+    if (!cameras.empty())
+        last = std::max(last, cameras.back().frame);
+    return last;
+}
+
+void GE::InputRecorder::spawn(const RecordedSpawn &spawn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    recording.spawns.push_back(spawn);
+}
+
+void GE::InputRecorder::camera(const RecordedCamera &camera)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    // Only changes are worth a line.
+    if (!recording.cameras.empty())
+    {
+        const RecordedCamera &last = recording.cameras.back();
+        if (last.position == camera.position && last.yaw == camera.yaw && last.pitch == camera.pitch)
+            return;
+    }
+    recording.cameras.push_back(camera);
+}
+
+bool GE::InputRecorder::save(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return recording.save(path);
+}
+
+GE::InputReplay::InputReplay(InputRecording _recording) : recording{std::move(_recording)}, lastFrame{recording.lastFrame()} {}
+
+const GE::RecordedCamera *GE::InputReplay::cameraAt(unsigned int frame)
+{
+    const RecordedCamera *latest = nullptr;
+    while (nextCamera < recording.cameras.size() && recording.cameras[nextCamera].frame <= frame)
+        latest = &recording.cameras[nextCamera++];
+    return latest;
+}
@@ -0,0 +1,90 @@
+#ifndef INPUTRECORDING_HPP
+#define INPUTRECORDING_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "EntityManager.hpp"
+
+namespace GE
+{
+    // A body launched into the world, with everything needed to launch it again.
+    struct RecordedSpawn
+    {
+        unsigned int frame;     // physics tick the body was added before
+        EntityType type;
+        glm::vec3 size;         // radius in x for balls and donuts, dimensions for cubes
+        glm::vec3 position;
+        glm::vec3 velocity;
+        glm::mat4 rotation;
+    };
+
+    struct RecordedCamera
+    {
+        unsigned int frame;
+        glm::vec3 position;
+        float yaw;
+        float pitch;
+    };
+
+    // Everything that drives a session, stamped with physics ticks rather than
+    // wall time: replayed on a fixed timestep, the same spawns land on the same
+    // ticks, so two runs simulate exactly the same workload.
+    //
+    // Stored as text, one event per line:
+    //   spawn <frame> <type> <size xyz> <position xyz> <velocity xyz> <rotation 3x3, column major>
+    //   camera <frame> <position xyz> <yaw> <pitch>
+    struct InputRecording
+    {
+        std::vector<RecordedSpawn> spawns;
+        std::vector<RecordedCamera> cameras;
+
+        bool save(const std::string &path) const;
+        bool load(const std::string &path);
+        unsigned int lastFrame() const;
+    };
+
+    // Collects events while the demo runs. Spawns and camera poses are stamped
+    // on the physics thread, saving happens on the render thread, hence the lock.
+    struct InputRecorder
+    {
+        void spawn(const RecordedSpawn &spawn);
+        void camera(const RecordedCamera &camera);
+        bool save(const std::string &path);
+
+    private:
+        std::mutex mutex;
+        InputRecording recording;
+    };
+
+    // Hands a recording back tick by tick.
+    struct InputReplay
+    {
+        explicit InputReplay(InputRecording recording);
+
+        // Spawns due before stepping from `frame`, in recorded order.
+        template <class F>
+        void spawnsAt(unsigned int frame, F launch)
+        {
+            while (nextSpawn < recording.spawns.size() && recording.spawns[nextSpawn].frame <= frame)
+                launch(recording.spawns[nextSpawn++]);
+        }
+        // Latest camera pose at `frame`, null when it did not change.
+        const RecordedCamera *cameraAt(unsigned int frame);
+        bool finished(unsigned int frame) const { return frame > lastFrame; }
+
+        const InputRecording &get() const { return recording; }
+
+    private:
+        InputRecording recording;
+        unsigned int lastFrame;
+        std::size_t nextSpawn = 0;
+        std::size_t nextCamera = 0;
+    };
+} // namespace GE
+
+#endif
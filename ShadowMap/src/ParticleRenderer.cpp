@@ -0,0 +1,68 @@
+#include "ParticleRenderer.hpp"
+
+#include <cstddef>
+
+GE::ParticleRenderer::ParticleRenderer(const Model &model) : mesh{model.meshes[0]}
+{
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &instanceVBO);
+
+    // Same vertex layout as Mesh::setupMesh.
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+
+    // Centre and radius, one per instance.
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void *)0);
+    glVertexAttribDivisor(3, 1);
+    glBindVertexArray(0);
+}
+
+GE::ParticleRenderer::~ParticleRenderer()
+{
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &instanceVBO);
+}
+
+void GE::ParticleRenderer::upload(const DebrisParticles &particles)
+{
+    const std::size_t n = particles.size();
+    instances.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+        instances[i] = {particles.x[i], particles.y[i], particles.z[i], particles.radius[i]};
+    count = static_cast<int>(n);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (n > instanceCapacity)
+    {
+        instanceCapacity = n + n / 2;
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    }
+    if (n)
+        glBufferSubData(GL_ARRAY_BUFFER, 0, n * sizeof(glm::vec4), instances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GE::ParticleRenderer::Draw(Shader &shader) const
+{
+    if (!count)
+        return;
+
+    glActiveTexture(GL_TEXTURE0);
+    shader.setInt("texture_diffuse", 0);
+    glBindTexture(GL_TEXTURE_2D, mesh.textures[0].id);
+
+    shader.setBool("instanced", true);
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<int>(mesh.indices.size()), GL_UNSIGNED_INT, 0, count);
+    glBindVertexArray(0);
+    shader.setBool("instanced", false);
+}
@@ -0,0 +1,41 @@
+#ifndef PARTICLERENDERER_HPP
+#define PARTICLERENDERER_HPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Model.hpp"
+#include "Particles.hpp"
+#include "Shader.hpp"
+
+namespace GE
+{
+    // Draws DebrisParticles as instances of a model's first mesh (the
+    // SphereModel) in one call per pass. Every instance is a vec4, centre and
+    // radius, at attribute 3 of a VAO of its own that shares the mesh's vertex
+    // and index buffers; the vertex shaders scale and move the mesh by it when
+    // `instanced` is set.
+    struct ParticleRenderer
+    {
+        explicit ParticleRenderer(const Model &model);
+        ParticleRenderer(const ParticleRenderer &) = delete;
+        ParticleRenderer &operator=(const ParticleRenderer &) = delete;
+        ~ParticleRenderer();
+
+        // Render thread, once per frame after DebrisParticles::update().
+        void upload(const DebrisParticles &particles);
+        // The caller sets up the shader, `model` included.
+        void Draw(Shader &shader) const;
+
+    private:
+        const Mesh &mesh;
+        unsigned int VAO = 0;
+        unsigned int instanceVBO = 0;
+        std::size_t instanceCapacity = 0;
+        int count = 0;
+        std::vector<glm::vec4> instances;
+    };
+} // namespace GE
+
+#endif
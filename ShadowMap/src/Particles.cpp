@@ -0,0 +1,136 @@
+#include "Particles.hpp"
+
+#include <cfloat>
+
+bool GE::DebrisParticles::spawn(const glm::vec3 &position, const glm::vec3 &velocity, float r)
+{
+    if (x.size() >= capacity)
+        return false;
+    x.push_back(position.x);
+    y.push_back(position.y);
+    z.push_back(position.z);
+    vx.push_back(velocity.x);
+    vy.push_back(velocity.y);
+    vz.push_back(velocity.z);
+    radius.push_back(r);
+    age.push_back(0.0f);
+    return true;
+}
+
+void GE::DebrisParticles::clear()
+{
+    for (auto *v : {&x, &y, &z, &vx, &vy, &vz, &radius, &age})
+        v->clear();
+}
+
+void GE::DebrisParticles::update(float dt)
+{
+    const std::size_t n = x.size();
+    if (n == 0 || dt <= 0.0f)
+        return;
+
+    float *px = x.data(), *py = y.data(), *pz = z.data();
+    float *pvx = vx.data(), *pvy = vy.data(), *pvz = vz.data();
+    const float *pr = radius.data();
+    float *page = age.data();
+
+    // Ground height under every particle. A gather on the terrain, so kept out of the loop below.
+    floor.resize(n);
+    float *pf = floor.data();
+    if (field)
+        for (std::size_t i = 0; i < n; ++i)
+            pf[i] = fieldOrigin.y + field->heightAt(px[i] - fieldOrigin.x, pz[i] - fieldOrigin.z);
+    else
+    {
+        const float ground = groundPlane ? groundY : -FLT_MAX;
+        for (std::size_t i = 0; i < n; ++i)
+            pf[i] = ground;
+    }
+
+    // The two loops below vectorize (g++ -O3 -fopt-info-vec) as long as they
+    // stay free of branches: selects only, no short circuit, see CCFLAGS.
+    // ivdep because the arrays are separate vectors the compiler cannot prove apart.
+
+    // Semi implicit Euler, then the ground as a branch free clamp and bounce.
+    const float gx = gravity.x * dt, gy = gravity.y * dt, gz = gravity.z * dt;
+    const float e = restitution, f = friction;
+#pragma GCC ivdep
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        pvx[i] += gx;
+        pvy[i] += gy;
+        pvz[i] += gz;
+        px[i] += pvx[i] * dt;
+        py[i] += pvy[i] * dt;
+        pz[i] += pvz[i] * dt;
+        page[i] += dt;
+
+        const float rest = pf[i] + pr[i];
+        const bool hit = py[i] < rest;
+        py[i] = hit ? rest : py[i];
+        pvy[i] = hit & (pvy[i] < 0.0f) ? -pvy[i] * e : pvy[i];
+        pvx[i] = hit ? pvx[i] * f : pvx[i];
+        pvz[i] = hit ? pvz[i] * f : pvz[i];
+    }
+
+    // Boxes: out through the face of least penetration, bouncing off it.
+    for (const Box &b : boxes)
+    {
+        // Copied out, the stores below could alias the box as far as the compiler knows.
+        const glm::vec3 lo = b.min, hi = b.max;
+#pragma GCC ivdep
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const float r = pr[i];
+            const float dxl = px[i] - (lo.x - r), dxh = (hi.x + r) - px[i];
+            const float dyl = py[i] - (lo.y - r), dyh = (hi.y + r) - py[i];
+            const float dzl = pz[i] - (lo.z - r), dzh = (hi.z + r) - pz[i];
+            const bool inside = (dxl > 0.0f) & (dxh > 0.0f) & (dyl > 0.0f) & (dyh > 0.0f) & (dzl > 0.0f) & (dzh > 0.0f);
+
+            const float ex = dxl < dxh ? dxl : dxh;
+            const float ey = dyl < dyh ? dyl : dyh;
+            const float ez = dzl < dzh ? dzl : dzh;
+            const bool useX = inside & (ex <= ey) & (ex <= ez);
+            const bool useY = inside & !useX & (ey <= ez);
+            const bool useZ = inside & !useX & !useY;
+
+            // Outward side of each axis, a velocity against it is bounced.
+            const float sx = dxl < dxh ? -1.0f : 1.0f;
+            const float sy = dyl < dyh ? -1.0f : 1.0f;
+            const float sz = dzl < dzh ? -1.0f : 1.0f;
+            const float ox = dxl < dxh ? -dxl : dxh;
+            const float oy = dyl < dyh ? -dyl : dyh;
+            const float oz = dzl < dzh ? -dzl : dzh;
+            const float kx = pvx[i] * sx < 0.0f ? -e : 1.0f;
+            const float ky = pvy[i] * sy < 0.0f ? -e : 1.0f;
+            const float kz = pvz[i] * sz < 0.0f ? -e : 1.0f;
+            const float slide = inside ? f : 1.0f;
+
+            // The face picked as a 0 or 1 factor. Selecting on useX/Y/Z
+            // directly gets jump threaded back into branches and conditional
+            // stores, which are not vectorized.
+            const float mx = useX ? 1.0f : 0.0f, my = useY ? 1.0f : 0.0f, mz = useZ ? 1.0f : 0.0f;
+            px[i] += mx * ox;
+            py[i] += my * oy;
+            pz[i] += mz * oz;
+            pvx[i] *= slide + mx * (kx - slide);
+            pvy[i] *= slide + my * (ky - slide);
+            pvz[i] *= slide + mz * (kz - slide);
+        }
+    }
+
+    // Retire expired and fallen particles, swapping the last one in.
+    for (std::size_t i = 0; i < x.size();)
+    {
+        if (age[i] < lifetime && y[i] > killY)
+        {
+            ++i;
+            continue;
+        }
+        for (auto *v : {&x, &y, &z, &vx, &vy, &vz, &radius, &age})
+        {
+            (*v)[i] = v->back();
+            v->pop_back();
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef PARTICLES_HPP
+#define PARTICLES_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Heightfield.hpp"
+
+namespace GE
+{
+    // Cosmetic balls that never enter the Bullet world.
+    //
+    // Particles are kept as structure of arrays. The integrate and box loops
+    // over them are branch free and vectorized by g++ -O3 given the math flags
+    // in the Makefile; the terrain lookup and retiring stay scalar.
+    // They only collide with the static world: the ground (a plane, or the
+    // terrain heightfield) and a short list of axis aligned boxes. Never with
+    // bodies or with each other, so their cost stays linear, about a hundred
+    // thousand for the price of a few thousand rigid bodies.
+    struct DebrisParticles
+    {
+        struct Box
+        {
+            glm::vec3 min;
+            glm::vec3 max;
+        };
+
+        // Infinite ground plane at groundY, used when there is no heightfield.
+        bool groundPlane = true;
+        float groundY = 0.0f;
+        // Terrain to collide with instead of the plane, not owned.
+        const Heightfield *field = nullptr;
+        // Where the heightfield's local origin is, as in Physics::addHeightfield.
+        glm::vec3 fieldOrigin{0.0f};
+        // Static obstacles. Every box costs one pass over all particles, keep it short.
+        std::vector<Box> boxes;
+
+        glm::vec3 gravity{0.0f, -9.8f, 0.0f};
+        float restitution = 0.4f;
+        // Tangential velocity kept per bounce or per tick of sliding on the ground.
+        float friction = 0.9f;
+        // Seconds before a particle is removed, and the height below which it goes at once.
+        float lifetime = 20.0f;
+        float killY = -100.0f;
+        std::size_t capacity = 200000;
+
+        // Returns false when full.
+        bool spawn(const glm::vec3 &position, const glm::vec3 &velocity, float radius);
+        // Integrates, collides and retires expired particles.
+        void update(float dt);
+        void clear();
+
+        std::size_t size() const { return x.size(); }
+
+        // Structure of arrays, read only outside of update().
+        std::vector<float> x, y, z;
+        std::vector<float> vx, vy, vz;
+        std::vector<float> radius;
+        std::vector<float> age;
+
+    private:
+        std::vector<float> floor;   // ground height under every particle, this update
+    };
+} // namespace GE
+
+#endif
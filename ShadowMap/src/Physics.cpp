@@ -1,77 +1,496 @@
 #include "Physics.hpp"
 
-#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include <LinearMath/btConvexHullComputer.h>
+
+#ifndef GE_HEADLESS
+#include "Model.hpp"
+#endif
+
+// Counted by btDiscreteDynamicsWorld each time a sweep stops a body short of its motion.
+extern int gNumClampedCcdMotions;
+
+namespace
+{
+    // Appends the faces of a box, hull or compound of them, in world space.
+    // False for shapes that cannot be turned into triangles this way.
+    bool Triangulate(const btCollisionShape *shape, const btTransform &t, std::vector<float> &vertices, std::vector<int> &indices)
+    {
+        auto vertex = [&](const btVector3 &v)
+        {
+            const btVector3 w = t * v;
+            vertices.insert(vertices.end(), {float(w.x()), float(w.y()), float(w.z())});
+            return int(vertices.size() / 3 - 1);
+        };
+
+        switch (shape->getShapeType())
+        {
+        case COMPOUND_SHAPE_PROXYTYPE:
+        {
+            const btCompoundShape *compound = static_cast<const btCompoundShape *>(shape);
+            for (int i = 0; i < compound->getNumChildShapes(); ++i)
+                if (!Triangulate(compound->getChildShape(i), t * compound->getChildTransform(i), vertices, indices))
+                    return false;
+            return true;
+        }
+        case BOX_SHAPE_PROXYTYPE:
+        case BOX_2D_SHAPE_PROXYTYPE:
+        {
+            // Box2D shapes collide as a box that is flat on one axis, margin included.
+            const btVector3 h = shape->getShapeType() == BOX_SHAPE_PROXYTYPE
+                                    ? static_cast<const btBoxShape *>(shape)->getHalfExtentsWithMargin()
+                                    : static_cast<const btBox2dShape *>(shape)->getHalfExtentsWithMargin();
+            int c[8];
+            for (int i = 0; i < 8; ++i)
+                c[i] = vertex(btVector3(i & 1 ? h.x() : -h.x(), i & 2 ? h.y() : -h.y(), i & 4 ? h.z() : -h.z()));
+            // Two triangles per face, counter clockwise seen from outside.
+            const int faces[6][4] = {{0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6}};
+            for (const auto &f : faces)
+                indices.insert(indices.end(), {c[f[0]], c[f[1]], c[f[2]], c[f[0]], c[f[2]], c[f[3]]});
+            return true;
+        }
+        case CONVEX_HULL_SHAPE_PROXYTYPE:
+        {
+            const btConvexHullShape *hull = static_cast<const btConvexHullShape *>(shape);
+            std::vector<btVector3> points(hull->getNumPoints());
+            for (int i = 0; i < hull->getNumPoints(); ++i)
+                hull->getVertex(i, points[i]);
+
+            btConvexHullComputer computer;
+            computer.compute(&points[0].x(), sizeof(btVector3), int(points.size()), 0, 0);
+            if (computer.faces.size() == 0)
+                return false;
+
+            const int first = int(vertices.size() / 3);
+            for (int i = 0; i < computer.vertices.size(); ++i)
+                vertex(computer.vertices[i]);
+            // Faces are convex polygons, fan them out from their first corner.
+            for (int f = 0; f < computer.faces.size(); ++f)
+            {
+                const btConvexHullComputer::Edge *start = &computer.edges[computer.faces[f]];
+                const btConvexHullComputer::Edge *e = start->getNextEdgeOfFace();
+                const int a = first + start->getSourceVertex();
+                for (const btConvexHullComputer::Edge *next = e->getNextEdgeOfFace(); next != start; e = next, next = next->getNextEdgeOfFace())
+                    indices.insert(indices.end(), {a, first + e->getSourceVertex(), first + next->getSourceVertex()});
+            }
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    btVector3 ToBt(const glm::vec3 &v) { return btVector3(v.x, v.y, v.z); }
+
+    GE::QueryHit ToHit(const btCollisionObject *object, const btVector3 &point, const btVector3 &normal, btScalar fraction)
+    {
+        return {static_cast<GE::Entity *>(object->getUserPointer()),
+                {point.x(), point.y(), point.z()},
+                {normal.x(), normal.y(), normal.z()},
+                fraction};
+    }
+
+    // Queries come from DefaultFilter, which every body accepts, and never hit sensors (the kill volume).
+    template <class Callback>
+    void SetQueryFilter(Callback &callback, int mask)
+    {
+        callback.m_collisionFilterGroup = btBroadphaseProxy::DefaultFilter;
+        callback.m_collisionFilterMask = mask & ~btBroadphaseProxy::SensorTrigger;
+    }
+
+    struct RayBatch : public btIParallelForBody
+    {
+        RayBatch(const btCollisionWorld &world, std::span<const GE::RayQuery> rays, std::span<GE::QueryHit> hits) : world(world), rays(rays), hits(hits) {}
+
+        void forLoop(int begin, int end) const override
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                const btVector3 from = ToBt(rays[i].from), to = ToBt(rays[i].to);
+                btCollisionWorld::ClosestRayResultCallback callback(from, to);
+                SetQueryFilter(callback, rays[i].mask);
+                world.rayTest(from, to, callback);
+                hits[i] = callback.hasHit() ? ToHit(callback.m_collisionObject, callback.m_hitPointWorld, callback.m_hitNormalWorld, callback.m_closestHitFraction)
+                                            : GE::QueryHit{};
+            }
+        }
+
+        const btCollisionWorld &world;
+        std::span<const GE::RayQuery> rays;
+        std::span<GE::QueryHit> hits;
+    };
+
+    struct SweepBatch : public btIParallelForBody
+    {
+        SweepBatch(const btCollisionWorld &world, std::span<const GE::SweepQuery> sweeps, std::span<GE::QueryHit> hits) : world(world), sweeps(sweeps), hits(hits) {}
+
+        void forLoop(int begin, int end) const override
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                const btVector3 from = ToBt(sweeps[i].from), to = ToBt(sweeps[i].to);
+                btSphereShape sphere(sweeps[i].radius);
+                btCollisionWorld::ClosestConvexResultCallback callback(from, to);
+                SetQueryFilter(callback, sweeps[i].mask);
+                world.convexSweepTest(&sphere, btTransform(btQuaternion::getIdentity(), from), btTransform(btQuaternion::getIdentity(), to), callback);
+                hits[i] = callback.hasHit() ? ToHit(callback.m_hitCollisionObject, callback.m_hitPointWorld, callback.m_hitNormalWorld, callback.m_closestHitFraction)
+                                            : GE::QueryHit{};
+            }
+        }
+
+        const btCollisionWorld &world;
+        std::span<const GE::SweepQuery> sweeps;
+        std::span<GE::QueryHit> hits;
+    };
+
+    // Removes the cached pairs the collision filter now rejects.
+    struct RejectedPairs : public btOverlapCallback
+    {
+        explicit RejectedPairs(const GE::CollisionFilter &filter) : filter{filter} {}
+
+        bool processOverlap(btBroadphasePair &pair) override
+        {
+            return !filter.needBroadphaseCollision(pair.m_pProxy0, pair.m_pProxy1);
+        }
+
+        const GE::CollisionFilter &filter;
+    };
+
+    // Queries of a few dozen microseconds each, small enough chunks to keep every thread busy.
+    constexpr int QUERY_GRAIN = 16;
+} // namespace
 
 #define MAX(X, Y) ((X > Y) ? X : Y)
 #define MIN(X, Y) ((X < Y) ? X : Y)
 
-GE::Physics::Physics()
+GE::Physics::Physics(PhysicsConfig config) : cookedShapes{config.shapeCacheDirectory}, hulls{&cookedShapes}, lod{config.lod}, tickRate{config.tickRate}, maxCatchUpSteps{config.maxCatchUpSteps}, ccdThresholdScale{config.ccdThresholdScale}, profile{config.profile}
 {
-    broadphase = new btDbvtBroadphase();
-    collisionConfiguration = new btDefaultCollisionConfiguration();
-    dispatcher = new btCollisionDispatcher(collisionConfiguration);
-    solver = new btSequentialImpulseConstraintSolver();
-    dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+    broadphase = CreateBroadphase(config);
+    broadphaseType = config.broadphase;
+
+    // The scheduler has to be installed before any Mt object is created, and
+    // Bullet takes the thread installing it for its main thread.
+    // btCreateDefaultTaskScheduler() returns null when Bullet was built
+    // without BT_THREADSAFE, in that case the Mt world and the query batches
+    // run sequentially.
+    if (config.multithreaded || config.parallelQueries)
+    {
+        taskScheduler = config.taskScheduler;
+        if (!taskScheduler)
+        {
+            taskScheduler = btCreateDefaultTaskScheduler();
+            ownsTaskScheduler = taskScheduler != nullptr;
+        }
+        if (!taskScheduler)
+            taskScheduler = btGetSequentialTaskScheduler();
+        btSetTaskScheduler(taskScheduler);
+        setNumThreads(config.numThreads);
+    }
+
+    if (!config.multithreaded)
+    {
+        collisionConfiguration = new btDefaultCollisionConfiguration();
+        if (config.batchSphereContacts)
+            dispatcher = new SphereContactDispatcher(collisionConfiguration);
+        else
+            dispatcher = new btCollisionDispatcher(collisionConfiguration);
+        solver = new btSequentialImpulseConstraintSolver();
+        dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+    }
+    else
+    {
+        // Manifolds and algorithms are taken from the pools by several threads,
+        // grow them up front so they never fall back to the heap mid step.
+        btDefaultCollisionConstructionInfo cci;
+        cci.m_defaultMaxPersistentManifoldPoolSize = 80000;
+        cci.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+        collisionConfiguration = new btDefaultCollisionConfiguration(cci);
+
+        dispatcher = new btCollisionDispatcherMt(collisionConfiguration, 40);
+        solverPool = new btConstraintSolverPoolMt(BT_MAX_THREAD_COUNT);
+        solver = new btSequentialImpulseConstraintSolverMt();
+        dynamicsWorld = new btDiscreteDynamicsWorldMt(dispatcher, broadphase, solverPool, solver, collisionConfiguration);
+    }
     dynamicsWorld->setGravity(btVector3(0, -9.8f, 0));
+
+    ghostPairCallback = new btGhostPairCallback();
+    broadphase->getOverlappingPairCache()->setInternalGhostPairCallback(ghostPairCallback);
+    broadphase->getOverlappingPairCache()->setOverlapFilterCallback(&collisionFilter);
+
+    const float depth = 10000.0f;
+    killVolume = new btGhostObject();
+    killVolume->setCollisionShape(shapes.getBox(glm::vec3{depth}));
+    killVolume->setWorldTransform(btTransform(btQuaternion::getIdentity(), btVector3(0, config.killPlaneY - depth, 0)));
+    killVolume->setCollisionFlags(btCollisionObject::CF_NO_CONTACT_RESPONSE);
+    dynamicsWorld->addCollisionObject(killVolume, btBroadphaseProxy::SensorTrigger,
+                                      btBroadphaseProxy::AllFilter & ~(btBroadphaseProxy::StaticFilter | btBroadphaseProxy::SensorTrigger));
+}
+
+btBroadphaseInterface *GE::Physics::CreateBroadphase(const PhysicsConfig &config)
+{
+    const btVector3 worldMin(config.worldMin.x, config.worldMin.y, config.worldMin.z);
+    const btVector3 worldMax(config.worldMax.x, config.worldMax.y, config.worldMax.z);
+
+    switch (config.broadphase)
+    {
+    case BroadphaseType::AxisSweep:
+        // 16 bit handles, btAxisSweep3 cannot hold more than that.
+        return new btAxisSweep3(worldMin, worldMax, MIN(config.maxBodies, 32766));
+    case BroadphaseType::AxisSweep32:
+        return new bt32BitAxisSweep3(worldMin, worldMax, config.maxBodies);
+    case BroadphaseType::Grid:
+        return new GridBroadphase(worldMin, worldMax, config.gridCellSize);
+    case BroadphaseType::Dbvt:
+    default:
+        return new btDbvtBroadphase();
+    }
+}
+
+GE::Physics::~Physics()
+{
+    dynamicsWorld->removeCollisionObject(killVolume);
+    shapes.release(killVolume->getCollisionShape());
+    delete killVolume;
+    delete dynamicsWorld;
+    // The pair cache outlives the world, unhook the callback before freeing it.
+    broadphase->getOverlappingPairCache()->setInternalGhostPairCallback(nullptr);
+    delete ghostPairCallback;
+    delete solver;
+    delete solverPool;
+    delete dispatcher;
+    delete collisionConfiguration;
+    delete broadphase;
+    if (ownsTaskScheduler)
+    {
+        btSetTaskScheduler(btGetSequentialTaskScheduler());
+        delete taskScheduler;
+    }
+}
+
+void GE::Physics::setNumThreads(int numThreads)
+{
+    if (!taskScheduler)
+        return;
+    if (numThreads <= 0)
+        numThreads = std::thread::hardware_concurrency();
+    numThreads = MAX(numThreads, 1);
+    taskScheduler->setNumThreads(MIN(numThreads, taskScheduler->getMaxNumThreads()));
+}
+
+int GE::Physics::getNumThreads() const
+{
+    return taskScheduler ? taskScheduler->getNumThreads() : 1;
+}
+
+void GE::Physics::rayTestBatch(std::span<const RayQuery> rays, std::span<QueryHit> hits) const
+{
+    const int n = static_cast<int>(MIN(rays.size(), hits.size()));
+    if (n == 0)
+        return;
+    RayBatch batch(*dynamicsWorld, rays, hits);
+    if (taskScheduler)
+        btParallelFor(0, n, QUERY_GRAIN, batch);
+    else
+        batch.forLoop(0, n);
+}
+
+void GE::Physics::sweepTestBatch(std::span<const SweepQuery> sweeps, std::span<QueryHit> hits) const
+{
+    const int n = static_cast<int>(MIN(sweeps.size(), hits.size()));
+    if (n == 0)
+        return;
+    SweepBatch batch(*dynamicsWorld, sweeps, hits);
+    if (taskScheduler)
+        btParallelFor(0, n, QUERY_GRAIN, batch);
+    else
+        batch.forLoop(0, n);
 }
 
 void GE::Physics::step(float dt)
 {
-    ++frame;
-    dynamicsWorld->stepSimulation(dt);
+    const float fixedDt = 1.0f / tickRate;
+    accumulator += dt;
+
+    int ticks = static_cast<int>(accumulator / fixedDt);
+    if (ticks > maxCatchUpSteps)
+    {
+        // Too far behind: run what we can afford and drop the rest.
+        ticks = maxCatchUpSteps;
+        accumulator = ticks * fixedDt;
+    }
+
+    ccdStats = {};
+    const int clampedBefore = gNumClampedCcdMotions;
+    const auto start = std::chrono::steady_clock::now();
+    if (profile && ticks > 0)
+        PhysicsStats::ResetProfile();
+    for (int i = 0; i < ticks; ++i)
+    {
+        // Motion states stamp their render slot with this, see RenderTransforms.
+        transforms.tick = ++frame;
+        dynamicsWorld->stepSimulation(fixedDt, 0);
+        collisionEvents.afterTick(frame);
+        lod.afterTick(*dynamicsWorld);
+        if (profile)
+            countCcd(fixedDt);
+        accumulator -= fixedDt;
+    }
+
+    if (profile && ticks > 0)
+    {
+        ccdStats.clamped = gNumClampedCcdMotions - clampedBefore;
+        stats.stepMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.frame = frame;
+        stats.ticks = ticks;
+        stats.collect(*dynamicsWorld);
+    }
+}
+
+void GE::Physics::setupCcd(btRigidBody &body)
+{
+    if (body.isStaticOrKinematicObject())
+    {
+        body.setCcdMotionThreshold(0);
+        return;
+    }
+
+    // Smallest half extent: moving further than that in one tick is what lets
+    // a body pass through a thin wall.
+    btVector3 aabbMin, aabbMax;
+    body.getCollisionShape()->getAabb(btTransform::getIdentity(), aabbMin, aabbMax);
+    const btVector3 halfExtents = 0.5f * (aabbMax - aabbMin);
+    const btScalar extent = halfExtents[halfExtents.minAxis()];
+
+    // Bullet only sweeps a body whose motion over the tick exceeds the
+    // threshold, so resting and slow bodies never pay for it.
+    body.setCcdMotionThreshold(ccdThresholdScale * extent);
+    // Has to fit inside the shape, or the sweep reports hits the shape would not have.
+    body.setCcdSweptSphereRadius(0.5f * extent);
+}
+
+void GE::Physics::countCcd(float fixedDt)
+{
+    if (!dynamicsWorld->getDispatchInfo().m_useContinuous)
+        return;
+
+    // The test btDiscreteDynamicsWorld::integrateTransforms() makes. Integrating
+    // leaves the velocities alone, so predicting from the new transform moves
+    // the body as far as the tick did.
+    btCollisionObjectArray &objects = dynamicsWorld->getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        btRigidBody *body = btRigidBody::upcast(objects[i]);
+        if (!body || body->isStaticOrKinematicObject() || !body->isActive() || body->getCcdSquareMotionThreshold() == 0)
+            continue;
+        ++ccdStats.armed;
+        btTransform predicted;
+        body->predictIntegratedTransform(fixedDt, predicted);
+        if ((predicted.getOrigin() - body->getWorldTransform().getOrigin()).length2() > body->getCcdSquareMotionThreshold())
+            ++ccdStats.swept;
+    }
+}
+
+float GE::Physics::getInterpolationAlpha() const
+{
+    return MIN(MAX(accumulator * tickRate, 0.0f), 1.0f);
+}
+
+void GE::Physics::despawn(Entity &entity)
+{
+    if (entity.body && std::find(despawnQueue.begin(), despawnQueue.end(), &entity) == despawnQueue.end())
+        despawnQueue.push_back(&entity);
 }
 
 void GE::Physics::updateBodies()
 {
-    btAlignedObjectArray<btRigidBody *> rigidBodies = dynamicsWorld->getNonStaticRigidBodies();
-    for (int i = 0; i < rigidBodies.size(); ++i)
+    for (int i = 0; i < killVolume->getNumOverlappingObjects(); ++i)
     {
-        if (rigidBodies[i]->getWorldTransform().getOrigin().getY() < -100.0f)
-        {
-            btRigidBody *rb = rigidBodies[i];
-            Entity *entA = static_cast<Entity *>(rb->getUserPointer());
-            dynamicsWorld->removeRigidBody(rigidBodies[i]);
-            entA->model = nullptr;
-            // delete rb;
-            // rb = nullptr;
-        }
+        btRigidBody *rb = btRigidBody::upcast(killVolume->getOverlappingObject(i));
+        if (rb && !rb->isStaticOrKinematicObject())
+            despawn(*static_cast<Entity *>(rb->getUserPointer()));
+    }
+
+    // Removing bodies edits the volume's overlap list, hence the queue.
+    for (Entity *entity : despawnQueue)
+    {
+        btRigidBody *rb = entity->body;
+        dynamicsWorld->removeRigidBody(rb);
+        collisionEvents.forget(entity);
+        collisionFilter.forget(*entity);
+        shapes.release(rb->getCollisionShape());
+        bodies.destroy(rb);
+        transforms.release(entity->renderSlot);
+        entity->transforms = nullptr;
+        entity->body = nullptr;
+        entity->model = nullptr;
+        despawned.push_back({entity, frame});
     }
+    despawnQueue.clear();
 }
 
-void GE::Physics::Collision()
+btRigidBody *GE::Physics::createBody(Entity &entity, btScalar mass, const btTransform &transform, btCollisionShape *shape, const btVector3 &inertia)
 {
-    btDispatcher *dp = dynamicsWorld->getDispatcher();
-    const int numManifolds = dp->getNumManifolds();
-    for (int m = 0; m < numManifolds; ++m)
+    entity.transforms = &transforms;
+    entity.renderSlot = transforms.allocate(transform, entity.getScale(), &entity);
+    return bodies.create(mass, shape, inertia, transforms, entity.renderSlot);
+}
+
+void GE::Physics::addToWorld(Entity &entity)
+{
+    const bool isStatic = entity.body->isStaticObject();
+    const EntityType type = entity.getType();
+    dynamicsWorld->addRigidBody(entity.body, collisionFilter.group(type, isStatic), collisionFilter.mask(type, isStatic));
+}
+
+void GE::Physics::refilterBodies()
+{
+    // New masks go straight onto the existing proxies, re-adding every body
+    // would cost a linear search per removal and drop every resting manifold.
+    std::vector<btRigidBody *> widened;
+    btCollisionObjectArray &objects = dynamicsWorld->getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); ++i)
     {
-        btPersistentManifold *man = dp->getManifoldByIndexInternal(m);
-        const btRigidBody *obA = static_cast<const btRigidBody *>(man->getBody0());
-        const btRigidBody *obB = static_cast<const btRigidBody *>(man->getBody1());
-        const Entity *entA = static_cast<const Entity *>(obA->getUserPointer());
-        const Entity *entB = static_cast<const Entity *>(obB->getUserPointer());
-        // use user pointers to determine if objects are eligible for destruction.
-        // ...
-        const int numc = man->getNumContacts();
-        float totalImpact = 0.0f;
-        float threshold = 1000.0f;
-        for (int c = 0; c < numc; ++c)
-            totalImpact += man->getContactPoint(c).m_appliedImpulse;
-        if (totalImpact > threshold)
-        {
-            printf("[%4u][%u - %u] Power: %.3f \n", frame, entA->m_id, entB->m_id, totalImpact);
-        }
+        btRigidBody *rb = btRigidBody::upcast(objects[i]);
+        btBroadphaseProxy *proxy = rb ? rb->getBroadphaseHandle() : nullptr;
+        if (!proxy || !rb->getUserPointer())
+            continue;
+        const Entity &entity = *static_cast<Entity *>(rb->getUserPointer());
+        const bool isStatic = rb->isStaticObject();
+        const int mask = collisionFilter.mask(entity.getType(), isStatic);
+        if (!isStatic && (mask & ~proxy->m_collisionFilterMask))
+            widened.push_back(rb);
+        proxy->m_collisionFilterGroup = collisionFilter.group(entity.getType(), isStatic);
+        proxy->m_collisionFilterMask = mask;
     }
+
+    RejectedPairs rejected{collisionFilter};
+    broadphase->getOverlappingPairCache()->processAllOverlappingPairs(&rejected, dispatcher);
+
+    // Pairs the old masks ruled out are only found again by a new proxy.
+    // Static bodies share the rule with their dynamic partners, those suffice.
+    for (btRigidBody *rb : widened)
+        dynamicsWorld->refreshBroadphaseProxy(rb);
+}
+
+void GE::Physics::ignoreCollision(Entity &a, Entity &b)
+{
+    collisionFilter.ignore(a, b);
+    if (a.body && b.body && a.body->getBroadphaseHandle() && b.body->getBroadphaseHandle())
+        broadphase->getOverlappingPairCache()->removeOverlappingPair(a.body->getBroadphaseHandle(), b.body->getBroadphaseHandle(), dispatcher);
 }
 
 void GE::Physics::addRigidBOX(Entity &entity, const glm::vec3 pos, const glm::vec3 sizes, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags)
 {
-    btCollisionShape *shape = new btBoxShape(btVector3(sizes.x, sizes.y, sizes.z));
+    btCollisionShape *shape = shapes.getBox(sizes);
     btMatrix3x3 initRotation(rotation[0][0], rotation[0][1], rotation[0][2],
                              rotation[1][0], rotation[1][1], rotation[1][2],
                              rotation[2][0], rotation[2][1], rotation[2][2]);
 
     btTransform initTransform(initRotation, btVector3(pos.x, pos.y, pos.z));
-    btDefaultMotionState *MotionState = new btDefaultMotionState(initTransform);
     float mass;
     if (!(flags & btCollisionObject::CF_STATIC_OBJECT))
         mass = sizes.x * sizes.y * sizes.z;
@@ -79,54 +498,90 @@ void GE::Physics::addRigidBOX(Entity &entity, const glm::vec3 pos, const glm::ve
         mass = 0.0f;
     btVector3 Inertia(0, 0, 0);
     shape->calculateLocalInertia(mass, Inertia);
-    btRigidBody::btRigidBodyConstructionInfo RigicBodyCI(mass, MotionState, shape, Inertia);
-
-    entity.body = new btRigidBody(RigicBodyCI);
+    entity.body = createBody(entity, mass, initTransform, shape, Inertia);
     entity.body->setRestitution(.30f);
     entity.body->setFriction(2.0f);
     entity.body->setLinearVelocity({velocity.x, velocity.y, velocity.z});
-    entity.body->setCcdMotionThreshold(1e-7);
-    entity.body->setCcdSweptSphereRadius(0.50);
     entity.body->setCollisionFlags(flags);
     entity.body->setUserPointer(&entity);
-    dynamicsWorld->addRigidBody(entity.body);
+    setupCcd(*entity.body);
+    addToWorld(entity);
 }
 
 void GE::Physics::addSphereBOX(Entity &entity, const glm::vec3 pos, const float radius, const glm::vec3 velocity, btCollisionObject::CollisionFlags flags)
 {
-    btCollisionShape *sphereShape = new btSphereShape(radius);
+    btCollisionShape *sphereShape = shapes.getSphere(radius);
 
     btTransform initTransform(btQuaternion(0, 0, 0, 1), btVector3(pos.x, pos.y, pos.z));
-    btDefaultMotionState *sphereMotionState = new btDefaultMotionState(initTransform);
-
     float density = 1.0f;
     btScalar mass = density * 4.0 / 3.0 * glm::pi<float>() * radius * radius;
 
     btVector3 sphereInertia(10.0, 10.0, 10.0);
     sphereShape->calculateLocalInertia(mass, sphereInertia);
-    btRigidBody::btRigidBodyConstructionInfo sphereRigicBodyCI(mass, sphereMotionState, sphereShape, sphereInertia);
-
-    entity.body = new btRigidBody(sphereRigicBodyCI);
+    entity.body = createBody(entity, mass, initTransform, sphereShape, sphereInertia);
     entity.body->setRestitution(0.80f);
     entity.body->setFriction(1.0f);
     entity.body->setLinearVelocity({velocity.x, velocity.y, velocity.z});
     entity.body->setCollisionFlags(flags);
     entity.body->setUserPointer(&entity);
-    entity.body->setCcdMotionThreshold(1e-7);
-    entity.body->setCcdSweptSphereRadius(0.50);
-    dynamicsWorld->addRigidBody(entity.body);
+    setupCcd(*entity.body);
+    addToWorld(entity);
+}
+
+std::size_t GE::Physics::spawnSpheres(std::span<Entity *const> entities, std::span<const glm::vec3> positions, std::span<const glm::vec3> velocities, const float radius, btCollisionObject::CollisionFlags flags)
+{
+    std::size_t n = MIN(entities.size(), positions.size());
+    if (!velocities.empty())
+        n = MIN(n, velocities.size());
+    btAssert(n == entities.size());
+    if (n == 0)
+        return 0;
+
+    btSphereShape *sphereShape = shapes.getSphere(radius);
+    shapes.retain(sphereShape, n - 1);
+
+    // Same mass and inertia as addSphereBOX.
+    float density = 1.0f;
+    btScalar mass = density * 4.0 / 3.0 * glm::pi<float>() * radius * radius;
+    btVector3 sphereInertia(10.0, 10.0, 10.0);
+    sphereShape->calculateLocalInertia(mass, sphereInertia);
+
+    bodies.reserve(n);
+    transforms.reserve(n);
+    dynamicsWorld->getCollisionObjectArray().reserve(dynamicsWorld->getNumCollisionObjects() + n);
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        Entity &entity = *entities[i];
+        const glm::vec3 &pos = positions[i];
+        const glm::vec3 velocity = velocities.empty() ? glm::vec3{0} : velocities[i];
+
+        btTransform initTransform(btQuaternion(0, 0, 0, 1), btVector3(pos.x, pos.y, pos.z));
+        entity.body = createBody(entity, mass, initTransform, sphereShape, sphereInertia);
+        entity.body->setRestitution(0.80f);
+        entity.body->setFriction(1.0f);
+        entity.body->setLinearVelocity({velocity.x, velocity.y, velocity.z});
+        entity.body->setCollisionFlags(flags);
+        entity.body->setUserPointer(&entity);
+        setupCcd(*entity.body);
+        addToWorld(entity);
+    }
+
+    // Thousands of incremental inserts leave the dynamic tree unbalanced, one
+    // top down rebuild is cheaper than the first few steps on a bad tree.
+    if (broadphaseType == BroadphaseType::Dbvt)
+        static_cast<btDbvtBroadphase *>(broadphase)->optimize();
+    return n;
 }
 
 void GE::Physics::add2DBOX(Entity &entity, const glm::vec3 pos, const glm::vec2 dimensions, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags)
 {
-    btBox2dShape *shape = new btBox2dShape(btVector3(dimensions.x, 0.0f, dimensions.y));
+    btBox2dShape *shape = shapes.getBox2D(dimensions);
     btMatrix3x3 initRotation(rotation[0][0], rotation[0][1], rotation[0][2],
                              rotation[1][0], rotation[1][1], rotation[1][2],
                              rotation[2][0], rotation[2][1], rotation[2][2]);
 
     btTransform initTransform(initRotation, btVector3(pos.x, pos.y, pos.z));
-    btDefaultMotionState *MotionState = new btDefaultMotionState(initTransform);
-
     float mass;
     if (!(flags & btCollisionObject::CF_STATIC_OBJECT))
         mass = dimensions.x * dimensions.y;
@@ -135,147 +590,120 @@ void GE::Physics::add2DBOX(Entity &entity, const glm::vec3 pos, const glm::vec2
 
     btVector3 inertia(10.0, 10.0, 10.0);
     shape->calculateLocalInertia(mass, inertia);
-    btRigidBody::btRigidBodyConstructionInfo RigicBodyCI(mass, MotionState, shape, inertia);
-    entity.body = new btRigidBody(RigicBodyCI);
+    entity.body = createBody(entity, mass, initTransform, shape, inertia);
     entity.body->setRestitution(0.40f);
     entity.body->setFriction(1.0f);
     entity.body->setUserPointer(&entity);
     entity.body->setCollisionFlags(flags);
 
-    dynamicsWorld->addRigidBody(entity.body);
+    addToWorld(entity);
 }
 
-void GE::Physics::addRigidBoxFromModel(Entity &entity, const Model *model, const glm::vec3 pos, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags)
+void GE::Physics::addHeightfield(Entity &entity, Heightfield &field, const glm::vec3 pos, btCollisionObject::CollisionFlags flags)
 {
-    // SHAPE
-    static std::unordered_map<const Model *, btConvexHullShape *> models_parsed;
-    float max_x = -99999.0;
-    float min_x = 99999.0;
-    float max_y = -99999.0;
-    float min_y = 99999.0;
-    float max_z = -99999.0;
-    float min_z = 99999.0;
-
-    if (models_parsed.find(model) == models_parsed.end())
-    {
-        float *vertex_positions;
-        unsigned int hitbox_vertices = model->GetRawPositions(&vertex_positions);
-        btConvexHullShape *new_shape = new btConvexHullShape();
-        new_shape->optimizeConvexHull();
+    btHeightfieldTerrainShape *shape = field.getShape();
+    // Bullet centres the shape on the middle of its height range, shift it back
+    // so heights stay relative to `pos`.
+    btTransform initTransform(btQuaternion::getIdentity(), btVector3(pos.x, pos.y + 0.5f * (field.minHeight + field.maxHeight), pos.z));
+    entity.body = createBody(entity, 0.0f, initTransform, shape, btVector3(0, 0, 0));
+    entity.body->setRestitution(0.5f);
+    entity.body->setFriction(1.0f);
+    entity.body->setCollisionFlags(flags | btCollisionObject::CF_STATIC_OBJECT);
+    entity.body->setUserPointer(&entity);
+    setupCcd(*entity.body);
+    addToWorld(entity);
+}
+
+std::size_t GE::Physics::mergeStatics(Entity &into, const std::string &key)
+{
+    std::vector<Entity *> merged;
+    std::vector<float> vertices;
+    std::vector<int> indices;
 
-        for (unsigned int i = 0; i < hitbox_vertices; i += 3)
+    btCollisionObjectArray &objects = dynamicsWorld->getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        btRigidBody *rb = btRigidBody::upcast(objects[i]);
+        if (!rb || !rb->isStaticObject() || !rb->getUserPointer())
+            continue;
+
+        // Only keep the triangles of the bodies that can be merged whole.
+        const std::size_t nv = vertices.size(), ni = indices.size();
+        if (Triangulate(rb->getCollisionShape(), rb->getWorldTransform(), vertices, indices))
+            merged.push_back(static_cast<Entity *>(rb->getUserPointer()));
+        else
         {
-            new_shape->addPoint(btVector3(vertex_positions[i], vertex_positions[i + 1], vertex_positions[i + 2]));
-            max_x = MAX(vertex_positions[i], max_x);
-            min_x = MIN(vertex_positions[i], min_x);
-            max_y = MAX(vertex_positions[i + 1], max_y);
-            min_y = MIN(vertex_positions[i + 1], min_y);
-            max_z = MAX(vertex_positions[i + 2], max_z);
-            min_z = MIN(vertex_positions[i + 2], min_z);
+            vertices.resize(nv);
+            indices.resize(ni);
         }
-
-        models_parsed.emplace(model, new_shape);
     }
+    if (merged.size() < 2)
+        return 0;
 
-    btConvexHullShape *shape = models_parsed.at(model);
-
-    btMatrix3x3 initRotation(rotation[0][0], rotation[0][1], rotation[0][2],
-                             rotation[1][0], rotation[1][1], rotation[1][2],
-                             rotation[2][0], rotation[2][1], rotation[2][2]);
-    btTransform initTransform(initRotation, btVector3(pos.x, pos.y, pos.z));
-    btDefaultMotionState *MotionState = new btDefaultMotionState(initTransform);
-
-    float mass;
-    if (!(flags & btCollisionObject::CF_STATIC_OBJECT))
+    for (Entity *e : merged)
     {
-        btVector3 c;
-        float r;
-        shape->getBoundingSphere(c, r);
-        float volume = 4.0f / 3.0f * 3.14f * r * r;
-        float density = 1.0;
-        mass = volume * density;
+        btRigidBody *rb = e->body;
+        dynamicsWorld->removeRigidBody(rb);
+        collisionEvents.forget(e);
+        collisionFilter.forget(*e);
+        shapes.release(rb->getCollisionShape());
+        bodies.destroy(rb);
+        e->body = nullptr;
+        mergedStatics.push_back(e);
     }
-    else
-        mass = 0.0f;
-
-    btVector3 Inertia(1, 1, 1);
-    shape->calculateLocalInertia(mass, Inertia);
-
-    btRigidBody::btRigidBodyConstructionInfo RigicBodyCI(mass, MotionState, shape, Inertia);
 
-    entity.body = new btRigidBody(RigicBodyCI);
-    entity.body->setRestitution(0.80f);
-    entity.body->setFriction(0.9f);
-    entity.body->setLinearVelocity({velocity.x, velocity.y, velocity.z});
-    entity.body->setUserPointer(&entity);
-    entity.body->setCcdMotionThreshold(1e-7);
-    entity.body->setCcdSweptSphereRadius(0.50);
-    entity.body->setCollisionFlags(flags);
-    dynamicsWorld->addRigidBody(entity.body);
+    btBvhTriangleMeshShape *shape = cookedShapes.getTriangleMesh(key, vertices, indices);
+    into.body = createBody(into, 0.0f, btTransform::getIdentity(), shape, btVector3(0, 0, 0));
+    into.body->setRestitution(0.40f);
+    into.body->setFriction(1.0f);
+    into.body->setCollisionFlags(btCollisionObject::CF_STATIC_OBJECT);
+    into.body->setUserPointer(&into);
+    addToWorld(into);
+    return merged.size();
 }
 
-void GE::Physics::addRigidBoxFromModel(Entity &entity, std::string model_name, const float *points, int n_points, const glm::vec3 pos, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags)
+#ifndef GE_HEADLESS
+void GE::Physics::addRigidBoxFromModel(Entity &entity, const Model *model, const glm::vec3 pos, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags)
 {
-    static std::unordered_map<std::string, btConvexHullShape *> models_parsed;
-    float max_x = -99999.0;
-    float min_x = 99999.0;
-    float max_y = -99999.0;
-    float min_y = 99999.0;
-    float max_z = -99999.0;
-    float min_z = 99999.0;
-
-    if (models_parsed.find(model_name) == models_parsed.end())
+    std::string key = model->name.empty() ? std::to_string(reinterpret_cast<std::uintptr_t>(model)) : model->name;
+    const HullCache::Hull *hull = hulls.find(key);
+    if (!hull)
     {
-        btConvexHullShape *new_shape = new btConvexHullShape();
-
-        for (unsigned int i = 0; i < n_points; i += 3)
-        {
-            new_shape->addPoint(btVector3(points[i], points[i + 1], points[i + 2]));
-            max_x = MAX(points[i], max_x);
-            min_x = MIN(points[i], min_x);
-            max_y = MAX(points[i + 1], max_y);
-            min_y = MIN(points[i + 1], min_y);
-            max_z = MAX(points[i + 2], max_z);
-            min_z = MIN(points[i + 2], min_z);
-        }
-        new_shape->optimizeConvexHull();
-
-        models_parsed.emplace(model_name, new_shape);
+        float *vertex_positions;
+        unsigned int hitbox_vertices = model->GetRawPositions(&vertex_positions);
+        hull = &hulls.get(key, vertex_positions, hitbox_vertices);
     }
+    addHull(entity, *hull, pos, velocity, rotation, flags);
+}
+#endif
+
+void GE::Physics::addRigidBoxFromModel(Entity &entity, std::string model_name, const float *points, int n_points, const glm::vec3 pos, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags)
+{
+    addHull(entity, hulls.get(model_name, points, n_points), pos, velocity, rotation, flags);
+}
 
-    btConvexHullShape* shape = models_parsed.at(model_name);
+void GE::Physics::addDecomposedModel(Entity &entity, std::string model_name, std::string cache_path, const float *points, int n_points, const glm::vec3 pos, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags)
+{
+    addHull(entity, hulls.getCompound(model_name, points, n_points, cache_path), pos, velocity, rotation, flags);
+}
 
+void GE::Physics::addHull(Entity &entity, const HullCache::Hull &hull, const glm::vec3 pos, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags)
+{
     btMatrix3x3 initRotation(rotation[0][0], rotation[0][1], rotation[0][2],
                              rotation[1][0], rotation[1][1], rotation[1][2],
                              rotation[2][0], rotation[2][1], rotation[2][2]);
     btTransform initTransform(initRotation, btVector3(pos.x, pos.y, pos.z));
-    btDefaultMotionState *MotionState = new btDefaultMotionState(initTransform);
-
-    float mass;
-    if (!(flags & btCollisionObject::CF_STATIC_OBJECT))
-    {
-        btVector3 c;
-        float r;
-        shape->getBoundingSphere(c, r);
-        float volume = 4.0f / 3.0f * 3.14f * r * r;
-        float density = 1.0;
-        mass = volume * density;
-    }
-    else
-        mass = 0.0f;
-
-    btVector3 Inertia(1, 1, 1);
-    shape->calculateLocalInertia(mass, Inertia);
 
-    btRigidBody::btRigidBodyConstructionInfo RigicBodyCI(mass, MotionState, shape, Inertia);
+    float density = 1.0;
+    float mass = (flags & btCollisionObject::CF_STATIC_OBJECT) ? 0.0f : hull.volume * density;
+    btVector3 Inertia = hull.unitInertia * mass;
 
-    entity.body = new btRigidBody(RigicBodyCI);
+    entity.body = createBody(entity, mass, initTransform, hull.shape, Inertia);
     entity.body->setRestitution(0.80f);
     entity.body->setFriction(0.9f);
     entity.body->setLinearVelocity({velocity.x, velocity.y, velocity.z});
     entity.body->setUserPointer(&entity);
-    entity.body->setCcdMotionThreshold(1e-7);
-    entity.body->setCcdSweptSphereRadius(0.50);
     entity.body->setCollisionFlags(flags);
-    dynamicsWorld->addRigidBody(entity.body);
+    setupCcd(*entity.body);
+    addToWorld(entity);
 }
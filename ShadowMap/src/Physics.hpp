@@ -3,34 +3,237 @@
 
 #include <btBulletDynamicsCommon.h>
 #include <BulletCollision/CollisionShapes/btBox2dShape.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <LinearMath/btThreads.h>
 #include <glm/glm.hpp>
 
-#include "Model.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
 
 #include "EntityManager.hpp"
+#include "ShapeRegistry.hpp"
+#include "GridBroadphase.hpp"
+#include "ShapeCache.hpp"
+#include "HullCache.hpp"
+#include "BodyPool.hpp"
+#include "RenderTransforms.hpp"
+#include "CollisionEvents.hpp"
+#include "CollisionFilter.hpp"
+#include "SphereContacts.hpp"
+#include "PhysicsLod.hpp"
+#include "Heightfield.hpp"
+#include "PhysicsStats.hpp"
 
 namespace GE
 {
+    enum class BroadphaseType : std::uint8_t
+    {
+        Dbvt,           // dynamic AABB trees, no bounds needed
+        AxisSweep,      // btAxisSweep3, 16 bit quantized sweep and prune
+        AxisSweep32,    // bt32BitAxisSweep3, for more than ~16k proxies
+        Grid            // GridBroadphase, uniform cells
+    };
+
+    // One ray of Physics::rayTestBatch(). `mask` selects the collision groups
+    // it can hit (CollisionFilter::group()), the kill volume is never hit.
+    struct RayQuery
+    {
+        glm::vec3 from;
+        glm::vec3 to;
+        int mask = btBroadphaseProxy::AllFilter;
+    };
+
+    // A sphere moved from `from` to `to` by Physics::sweepTestBatch().
+    struct SweepQuery
+    {
+        glm::vec3 from;
+        glm::vec3 to;
+        float radius;
+        int mask = btBroadphaseProxy::AllFilter;
+    };
+
+    // Closest hit of a query, entity == nullptr when nothing was hit.
+    struct QueryHit
+    {
+        Entity *entity = nullptr;
+        glm::vec3 point{0.0f};
+        glm::vec3 normal{0.0f};
+        float fraction = 1.0f;      // along from -> to
+    };
+
+    struct PhysicsConfig
+    {
+        // Build btDiscreteDynamicsWorldMt instead of the single threaded world.
+        bool multithreaded = false;
+        // Worker threads for the task scheduler, 0 = one per core.
+        int numThreads = 0;
+        // Install the task scheduler for a single threaded world too, so that
+        // Physics::rayTestBatch() and sweepTestBatch() spread over its threads.
+        // The scheduler is process wide and driven from the thread that
+        // installed it, the one that built Physics: step and query from that
+        // thread only (PhysicsThread builds its Physics on its worker).
+        bool parallelQueries = false;
+        // Scheduler to run the world on (btGetOpenMPTaskScheduler(), btGetTBBTaskScheduler()...).
+        // Not owned. Null = Bullet's default scheduler, created and owned by Physics.
+        btITaskScheduler *taskScheduler = nullptr;
+        // Physics ticks per second.
+        float tickRate = 60.0f;
+        // Ticks run in one step() at most, the rest of a long frame is dropped.
+        int maxCatchUpSteps = 5;
+        BroadphaseType broadphase = BroadphaseType::Dbvt;
+        // World box for the sweep and prune and grid broadphases. Bodies are
+        // removed below y = -100, so nothing lives long outside of it.
+        glm::vec3 worldMin{-500.0f, -110.0f, -500.0f};
+        glm::vec3 worldMax{500.0f, 500.0f, 500.0f};
+        // Proxy capacity of the sweep and prune broadphases.
+        int maxBodies = 16384;
+        // Edge of a grid cell, about the size of the typical body.
+        float gridCellSize = 4.0f;
+        // Dynamic bodies falling below this are despawned.
+        float killPlaneY = -100.0f;
+        // Where cooked hulls and meshes are kept between runs, empty = cook every time.
+        std::string shapeCacheDirectory = "cache/shapes";
+        // A body gets swept (continuous) collision when it moves more than this
+        // many times its smallest half extent in one tick, see Physics::setupCcd.
+        float ccdThresholdScale = 1.0f;
+        // Far and off-screen bodies are put to sleep early, see PhysicsLod.
+        LodConfig lod;
+        // Fill Physics::stats after every step(): Bullet's profile timings and world counts.
+        bool profile = false;
+        // Sphere-sphere and sphere-box pairs go through SphereContactDispatcher's
+        // batched path. Single threaded world only, the Mt dispatcher is left as is.
+        bool batchSphereContacts = true;
+    };
+
     struct Physics
     {
-        Physics();
+        Physics(PhysicsConfig config = {});
+        static btBroadphaseInterface *CreateBroadphase(const PhysicsConfig &config);
+        ~Physics();
 
         btBroadphaseInterface *broadphase;
+        BroadphaseType broadphaseType;
         btDefaultCollisionConfiguration *collisionConfiguration;
         btCollisionDispatcher *dispatcher;
         btSequentialImpulseConstraintSolver *solver;
+        btConstraintSolverPoolMt *solverPool = nullptr;
+        btITaskScheduler *taskScheduler = nullptr;
+        bool ownsTaskScheduler = false;
         btDiscreteDynamicsWorld *dynamicsWorld;
+        ShapeRegistry shapes;
+        ShapeCache cookedShapes;
+        HullCache hulls;
+        BodyPool bodies;
+        RenderTransforms transforms;
+        CollisionEvents collisionEvents;
+        // Installed on the pair cache, decides which bodies get a broadphase pair at all.
+        CollisionFilter collisionFilter;
+        PhysicsLod lod;
         unsigned int frame = 0;
 
+        // Sensor filling everything under the kill plane. The broadphase keeps
+        // its overlap list, so only bodies that actually crossed are visited.
+        btGhostObject *killVolume;
+        btGhostPairCallback *ghostPairCallback;
+        std::vector<Entity *> despawnQueue;
+
+        struct Despawned
+        {
+            Entity *entity;
+            unsigned int frame;     // tick the body was removed after
+        };
+        // Entities whose bodies updateBodies() freed. The entities themselves
+        // belong to the EntityManager: whoever drains this deletes them once
+        // nothing (snapshots, queued events) can refer to them any more.
+        std::vector<Despawned> despawned;
+
+        // Static entities folded into one triangle mesh by mergeStatics(). They
+        // have no body any more but keep their render slot, so they are still drawn.
+        std::vector<Entity *> mergedStatics;
+
+        float tickRate;
+        int maxCatchUpSteps;
+        float accumulator = 0.0f;
+        float ccdThresholdScale;
+        bool profile;
+
+        struct CcdStats
+        {
+            unsigned int armed;     // awake bodies with a CCD threshold, summed over the ticks
+            unsigned int swept;     // of those, moving past their threshold: the ones Bullet swept
+            unsigned int clamped;   // sweeps that hit something and stopped the body short
+        };
+        // Of the last step(), only counted when profiling.
+        CcdStats ccdStats{};
+        // Of the last step() that ran a tick, only kept up to date when profiling.
+        PhysicsStats stats;
+
+        // Threads of the scheduler running the Mt world and the query batches,
+        // clamped to its maximum. 1 when there is no scheduler.
+        void setNumThreads(int numThreads);
+        int getNumThreads() const;
+
+        // Closest hit of every query into hits[i], the queries split across the
+        // scheduler's threads. `hits` is at least as long as the queries. Reads
+        // the world without locking: only call between steps, e.g. from a
+        // PhysicsThread::enqueue() command.
+        void rayTestBatch(std::span<const RayQuery> rays, std::span<QueryHit> hits) const;
+        void sweepTestBatch(std::span<const SweepQuery> sweeps, std::span<QueryHit> hits) const;
+
+        // Advances the world in fixed 1/tickRate ticks, leftover time carries over to the next call.
         void step(float deltaTime);
-        void Collision();
+        // How far (0..1) we are between the last tick and the next one, to blend render transforms.
+        float getInterpolationAlpha() const;
+        // Adds the last tick to ccdStats, with Bullet's own test for sweeping a body.
+        void countCcd(float fixedDt);
+        // Frees the bodies that reached the kill volume or were passed to despawn().
         void updateBodies();
+        // Deferred, the body is removed by the next updateBodies().
+        void despawn(Entity &entity);
+
+        // Motion threshold and swept sphere from the body's shape, off for static bodies.
+        // Call after the collision flags are set.
+        void setupCcd(btRigidBody &body);
+
+        // Pooled body for the entity, rendered through its slot in `transforms`.
+        btRigidBody *createBody(Entity &entity, btScalar mass, const btTransform &transform, btCollisionShape *shape, const btVector3 &inertia);
+        // Adds entity.body with the group and mask collisionFilter has for its type.
+        void addToWorld(Entity &entity);
+        // Writes fresh masks onto every body's proxy after the collisionFilter
+        // table changed, drops the pairs it now rejects and looks for new ones.
+        void refilterBodies();
+        // The two never collide again, an existing pair between them is dropped.
+        void ignoreCollision(Entity &a, Entity &b);
 
         void addRigidBOX( Entity &entity, const glm::vec3 pos, const glm::vec3 sizes, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags);
         void addSphereBOX( Entity &entity, const glm::vec3 pos, const float radius, const glm::vec3 velocity, btCollisionObject::CollisionFlags flags);
         void add2DBOX( Entity &entity, const glm::vec3 pos, const glm::vec2 dimensions, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags);
         void addRigidBoxFromModel( Entity &entity, const Model *model, glm::vec3 pos, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags);
         void addRigidBoxFromModel( Entity &entity, std::string model_name, const float* points, int n_points, const glm::vec3 pos, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags);
+        // Concave models: a compound of convex parts, decomposed once and cached in `cache_path`.
+        void addDecomposedModel( Entity &entity, std::string model_name, std::string cache_path, const float* points, int n_points, const glm::vec3 pos, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags);
+        // Spheres for a batch of entities (EntityManager::createEntities), entity i at
+        // positions[i]. One shape and one mass computation for all of them, pools
+        // grown once, and the broadphase tree rebuilt once after the inserts.
+        // `velocities` is either empty or as long as `entities`. Returns how many
+        // entities got a body: entities past the shortest span are left without one.
+        std::size_t spawnSpheres( std::span<Entity *const> entities, std::span<const glm::vec3> positions, std::span<const glm::vec3> velocities, const float radius, btCollisionObject::CollisionFlags flags);
+        // Static terrain, `pos` is where the heightfield's local origin ends up.
+        // The shape stays owned by `field`, which has to outlive the body.
+        void addHeightfield( Entity &entity, Heightfield &field, const glm::vec3 pos, btCollisionObject::CollisionFlags flags);
+        // Replaces every static box and convex hull body with one static
+        // btBvhTriangleMeshShape body for `into`: a single broadphase proxy, and
+        // a quantized BVH for the queries against it, cached on disk under `key`.
+        // Heightfields and other non polyhedral shapes stay as they are.
+        // Returns the number of bodies merged, nothing happens for fewer than two.
+        std::size_t mergeStatics(Entity &into, const std::string &key);
+        // Body for a cooked hull, mass and inertia come from the hull.
+        void addHull( Entity &entity, const HullCache::Hull &hull, const glm::vec3 pos, const glm::vec3 velocity, const glm::mat4 rotation, btCollisionObject::CollisionFlags flags);
 
     };
 
@@ -0,0 +1,89 @@
+#include "PhysicsLod.hpp"
+
+#include <algorithm>
+
+GE::PhysicsLod::PhysicsLod(LodConfig _config) : config{_config} {}
+
+void GE::PhysicsLod::setViewer(const glm::vec3 &position, const glm::vec3 &direction)
+{
+    viewer = {position.x, position.y, position.z};
+    viewDirection = {direction.x, direction.y, direction.z};
+}
+
+void GE::PhysicsLod::afterTick(btDiscreteDynamicsWorld &world)
+{
+    if (!config.enabled)
+        return;
+
+    btCollisionObjectArray &objects = world.getCollisionObjectArray();
+    const int n = objects.size();
+    if (n == 0)
+        return;
+
+    const int visits = std::min(config.bodiesPerTick, n);
+    for (int i = 0; i < visits; ++i)
+    {
+        if (cursor >= n)
+        {
+            cursor = 0;
+            reducedSeen = reducedInPass;
+            reducedInPass = 0;
+        }
+        btRigidBody *body = btRigidBody::upcast(objects[cursor++]);
+        if (!body || body->isStaticOrKinematicObject())
+            continue;
+
+        Tier tier = static_cast<Tier>(body->getUserIndex2());
+        bool reduce = wantsReduced(*body, tier);
+        if (reduce && tier != Reduced)
+            demote(*body);
+        else if (!reduce && tier == Reduced)
+            promote(*body);
+
+        if (reduce)
+        {
+            ++reducedInPass;
+            // Sleeping already, or still moving: leave it to the island manager.
+            // One slow sample is not enough, a bouncing body is slow at the top
+            // of every bounce; Bullet's deactivation time says how long it has been calm.
+            const btScalar sleepSpeed = config.sleepSpeed;
+            if (body->isActive() && body->getDeactivationTime() > config.sleepDelay &&
+                body->getLinearVelocity().length2() < sleepSpeed * sleepSpeed &&
+                body->getAngularVelocity().length2() < sleepSpeed * sleepSpeed)
+            {
+                body->setLinearVelocity({0, 0, 0});
+                body->setAngularVelocity({0, 0, 0});
+                // Undone by the island manager if it still touches awake bodies.
+                body->setActivationState(ISLAND_SLEEPING);
+            }
+        }
+    }
+}
+
+bool GE::PhysicsLod::wantsReduced(const btRigidBody &body, Tier tier) const
+{
+    const btVector3 offset = body.getWorldTransform().getOrigin() - viewer;
+    const btScalar scale = tier == Reduced ? config.hysteresis : 1.0f;
+    const btScalar nearDistance = config.nearDistance * scale;
+    const btScalar farDistance = config.farDistance * scale;
+
+    const btScalar distance2 = offset.length2();
+    if (distance2 < nearDistance * nearDistance)
+        return false;
+    if (distance2 > farDistance * farDistance)
+        return true;
+    // Behind the viewer.
+    return offset.dot(viewDirection) < 0;
+}
+
+void GE::PhysicsLod::demote(btRigidBody &body)
+{
+    body.setUserIndex2(Reduced);
+    body.setSleepingThresholds(config.sleepLinear, config.sleepAngular);
+}
+
+void GE::PhysicsLod::promote(btRigidBody &body)
+{
+    body.setUserIndex2(Full);
+    body.setSleepingThresholds(0.8f, 1.0f);
+}
@@ -0,0 +1,77 @@
+#ifndef PHYSICSLOD_HPP
+#define PHYSICSLOD_HPP
+
+#include <cstddef>
+
+#include <btBulletDynamicsCommon.h>
+#include <glm/glm.hpp>
+
+namespace GE
+{
+    struct LodConfig
+    {
+        bool enabled = true;
+        // Always full quality this close to the viewer.
+        float nearDistance = 60.0f;
+        // Reduced beyond this even when in view. Between the two, only bodies
+        // behind the viewer are reduced.
+        float farDistance = 200.0f;
+        // A reduced body is promoted once its distance drops below
+        // hysteresis * threshold, so bodies on the edge do not flip every visit.
+        float hysteresis = 0.8f;
+        // Reduced bodies slower than this are put to sleep, once they have
+        // also stayed under their sleeping thresholds for sleepDelay seconds.
+        float sleepSpeed = 1.5f;
+        float sleepDelay = 0.5f;
+        // Sleeping thresholds (linear, angular) of reduced bodies, Bullet's defaults are 0.8 and 1.0.
+        float sleepLinear = 2.0f;
+        float sleepAngular = 2.5f;
+        // Bodies visited per tick, the whole world is covered round robin.
+        int bodiesPerTick = 512;
+    };
+
+    // Distance based level of detail for dynamic bodies.
+    //
+    // Bullet steps every awake body of a world with the same dt, so there is no
+    // cheap way to tick a group at a lower rate. Instead far and off-screen
+    // bodies are made to sleep: they get looser sleeping thresholds and, once
+    // slow, are put to sleep outright. A sleeping body costs next to nothing
+    // until something hits it, and whatever hits it wakes it the usual way.
+    // Coming back within range restores Bullet's thresholds.
+    //
+    // The tier lives in the body's user index 2. A fresh body has Bullet's -1
+    // there, which counts as Full.
+    struct PhysicsLod
+    {
+        enum Tier : int
+        {
+            Full = 0,
+            Reduced = 1
+        };
+
+        PhysicsLod(LodConfig config = {});
+
+        // Where the camera is and where it looks, the direction does not need to be normalized.
+        void setViewer(const glm::vec3 &position, const glm::vec3 &direction);
+        // Re-tiers the next slice of bodies. Physics thread, after each tick.
+        void afterTick(btDiscreteDynamicsWorld &world);
+
+        // Bodies currently in the reduced tier, as far as the last full pass saw.
+        std::size_t reducedCount() const { return reducedSeen; }
+
+        LodConfig config;
+
+    private:
+        btVector3 viewer{0, 0, 0};
+        btVector3 viewDirection{0, 0, -1};
+        int cursor = 0;
+        std::size_t reducedInPass = 0;
+        std::size_t reducedSeen = 0;
+
+        bool wantsReduced(const btRigidBody &body, Tier tier) const;
+        void demote(btRigidBody &body);
+        void promote(btRigidBody &body);
+    };
+} // namespace GE
+
+#endif
@@ -0,0 +1,125 @@
+#include "PhysicsStats.hpp"
+
+#include <cstring>
+
+#include <LinearMath/btQuickprof.h>
+
+namespace
+{
+#ifndef BT_NO_PROFILE
+    void Flatten(CProfileIterator *it, const std::string &prefix, std::vector<GE::PhysicsStats::Section> &out)
+    {
+        std::vector<std::string> children;
+        for (it->First(); !it->Is_Done(); it->Next())
+        {
+            children.push_back(prefix + it->Get_Current_Name());
+            out.push_back({children.back(), it->Get_Current_Total_Time(), it->Get_Current_Total_Calls()});
+        }
+        for (std::size_t i = 0; i < children.size(); ++i)
+        {
+            it->Enter_Child(static_cast<int>(i));
+            Flatten(it, children[i] + "/", out);
+            it->Enter_Parent();
+        }
+    }
+#endif
+
+    // Last element of a section path.
+    const char *Leaf(const std::string &path)
+    {
+        std::size_t slash = path.rfind('/');
+        return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+    }
+} // namespace
+
+void GE::PhysicsStats::ResetProfile()
+{
+#ifndef BT_NO_PROFILE
+    CProfileManager::Reset();
+#endif
+}
+
+void GE::PhysicsStats::collect(btDiscreteDynamicsWorld &world)
+{
+    sections.clear();
+#ifndef BT_NO_PROFILE
+    CProfileIterator *it = CProfileManager::Get_Iterator();
+    Flatten(it, "", sections);
+    CProfileManager::Release_Iterator(it);
+#endif
+
+    broadphaseMs = narrowphaseMs = solverMs = integrateMs = ccdMs = islandsMs = 0.0f;
+    for (const Section &s : sections)
+    {
+        const char *name = Leaf(s.path);
+        if (!std::strcmp(name, "updateAabbs") || !std::strcmp(name, "calculateOverlappingPairs"))
+            broadphaseMs += s.ms;
+        else if (!std::strcmp(name, "dispatchAllCollisionPairs"))
+            narrowphaseMs += s.ms;
+        else if (!std::strcmp(name, "solveConstraints"))
+            solverMs += s.ms;
+        else if (!std::strcmp(name, "predictUnconstraintMotion") || !std::strcmp(name, "integrateTransforms"))
+            integrateMs += s.ms;
+        else if (!std::strcmp(name, "createPredictiveContacts"))
+            ccdMs += s.ms;
+        else if (!std::strcmp(name, "calculateSimulationIslands") || !std::strcmp(name, "updateActivationState"))
+            islandsMs += s.ms;
+    }
+
+    btCollisionObjectArray &objects = world.getCollisionObjectArray();
+    bodies = objects.size();
+    activeBodies = 0;
+    for (int i = 0; i < objects.size(); ++i)
+        if (objects[i]->isActive() && !objects[i]->isStaticOrKinematicObject())
+            ++activeBodies;
+
+    // The island manager leaves its elements sorted by island after a step.
+    btUnionFind &uf = world.getSimulationIslandManager()->getUnionFind();
+    islands = 0;
+    for (int i = 0; i < uf.getNumElements(); ++i)
+        if (i == 0 || uf.getElement(i).m_id != uf.getElement(i - 1).m_id)
+            ++islands;
+
+    overlappingPairs = world.getBroadphase()->getOverlappingPairCache()->getNumOverlappingPairs();
+    btDispatcher *dispatcher = world.getDispatcher();
+    manifolds = dispatcher->getNumManifolds();
+    contacts = 0;
+    for (int i = 0; i < manifolds; ++i)
+        contacts += dispatcher->getManifoldByIndexInternal(i)->getNumContacts();
+}
+
+bool GE::PhysicsStatsLog::open(const std::string &path)
+{
+    json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    out.open(path, std::ios::trunc);
+    if (out && !json)
+        out << "frame,ticks,step_ms,broadphase_ms,narrowphase_ms,solver_ms,integrate_ms,ccd_ms,islands_ms,"
+               "bodies,active_bodies,islands,pairs,manifolds,contacts\n";
+    return bool(out);
+}
+
+void GE::PhysicsStatsLog::write(const PhysicsStats &s)
+{
+    if (!out)
+        return;
+    if (!json)
+    {
+        out << s.frame << ',' << s.ticks << ',' << s.stepMs << ',' << s.broadphaseMs << ',' << s.narrowphaseMs << ','
+            << s.solverMs << ',' << s.integrateMs << ',' << s.ccdMs << ',' << s.islandsMs << ','
+            << s.bodies << ',' << s.activeBodies << ',' << s.islands << ',' << s.overlappingPairs << ','
+            << s.manifolds << ',' << s.contacts << '\n';
+        return;
+    }
+
+    out << "{\"frame\":" << s.frame << ",\"ticks\":" << s.ticks << ",\"step_ms\":" << s.stepMs
+        << ",\"broadphase_ms\":" << s.broadphaseMs << ",\"narrowphase_ms\":" << s.narrowphaseMs
+        << ",\"solver_ms\":" << s.solverMs << ",\"integrate_ms\":" << s.integrateMs
+        << ",\"ccd_ms\":" << s.ccdMs << ",\"islands_ms\":" << s.islandsMs
+        << ",\"bodies\":" << s.bodies << ",\"active_bodies\":" << s.activeBodies << ",\"islands\":" << s.islands
+        << ",\"pairs\":" << s.overlappingPairs << ",\"manifolds\":" << s.manifolds << ",\"contacts\":" << s.contacts
+        << ",\"sections\":[";
+    // Section names are Bullet identifiers, nothing to escape.
+    for (std::size_t i = 0; i < s.sections.size(); ++i)
+        out << (i ? "," : "") << "{\"path\":\"" << s.sections[i].path << "\",\"ms\":" << s.sections[i].ms << ",\"calls\":" << s.sections[i].calls << '}';
+    out << "]}\n";
+}
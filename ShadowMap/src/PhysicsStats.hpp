@@ -0,0 +1,68 @@
+#ifndef PHYSICSSTATS_HPP
+#define PHYSICSSTATS_HPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <btBulletDynamicsCommon.h>
+
+namespace GE
+{
+    // Where one step() went, filled by Physics when PhysicsConfig::profile is set.
+    //
+    // Timings come from Bullet's own CProfileManager, which every
+    // stepSimulation feeds with its BT_PROFILE scopes. The tree is reset
+    // before each step() and flattened after it, so a section holds the time of
+    // that step alone, summed over its ticks. The summary fields add up the
+    // sections that belong to each stage.
+    struct PhysicsStats
+    {
+        struct Section
+        {
+            std::string path;       // "stepSimulation/internalSingleStepSimulation/solveConstraints"
+            float ms;
+            int calls;
+        };
+
+        unsigned int frame = 0;
+        int ticks = 0;
+        float stepMs = 0.0f;        // wall time of step(), profiled or not
+
+        float broadphaseMs = 0.0f;  // updateAabbs, calculateOverlappingPairs
+        float narrowphaseMs = 0.0f; // dispatchAllCollisionPairs
+        float solverMs = 0.0f;      // solveConstraints
+        float integrateMs = 0.0f;   // predictUnconstraintMotion, integrateTransforms
+        float ccdMs = 0.0f;         // createPredictiveContacts
+        float islandsMs = 0.0f;     // calculateSimulationIslands, updateActivationState
+
+        int bodies = 0;
+        int activeBodies = 0;
+        int islands = 0;
+        int overlappingPairs = 0;
+        int manifolds = 0;
+        int contacts = 0;
+
+        std::vector<Section> sections;
+
+        // Reads the counts off the world and the profile tree off Bullet.
+        void collect(btDiscreteDynamicsWorld &world);
+        // Empties Bullet's profile tree, call right before stepping.
+        static void ResetProfile();
+    };
+
+    // Writes one line per step: CSV with the summary fields, or JSON lines
+    // (one object per step, sections included) when the path ends in .json.
+    struct PhysicsStatsLog
+    {
+        bool open(const std::string &path);
+        bool isOpen() const { return out.is_open(); }
+        void write(const PhysicsStats &stats);
+
+    private:
+        std::ofstream out;
+        bool json = false;
+    };
+} // namespace GE
+
+#endif
@@ -0,0 +1,184 @@
+#include "PhysicsThread.hpp"
+
+#include <future>
+
+GE::PhysicsThread::PhysicsThread(PhysicsConfig config)
+{
+    worker = std::thread(&PhysicsThread::run, this, std::move(config));
+    call([](Physics &) {});
+}
+
+GE::PhysicsThread::~PhysicsThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        running = false;
+        quit = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void GE::PhysicsThread::start()
+{
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        running = true;
+    }
+    wake.notify_one();
+}
+
+void GE::PhysicsThread::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        running = false;
+    }
+    // Commands run before the tick, once this one is done the worker only waits.
+    call([](Physics &) {});
+}
+
+void GE::PhysicsThread::enqueue(Command command)
+{
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        commands.push_back(std::move(command));
+    }
+    wake.notify_one();
+}
+
+void GE::PhysicsThread::call(const Command &command)
+{
+    std::promise<void> done;
+    std::future<void> finished = done.get_future();
+    enqueue([&](Physics &p)
+            {
+                command(p);
+                done.set_value();
+            });
+    finished.wait();
+}
+
+void GE::PhysicsThread::run(PhysicsConfig config)
+{
+    using clock = std::chrono::steady_clock;
+
+    // Built here, so that the task scheduler is installed by the thread that steps.
+    physics = std::make_unique<Physics>(std::move(config));
+
+    auto last = clock::now();
+    bool ticking = false;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(commandMutex);
+            wake.wait(lock, [this]
+                      { return quit || running || !commands.empty(); });
+            if (quit)
+                break;
+            std::swap(commands, executing);
+        }
+        for (auto &command : executing)
+            command(*physics);
+        executing.clear();
+
+        if (!running)
+        {
+            ticking = false;
+            continue;
+        }
+
+        auto now = clock::now();
+        // The time spent stopped is not caught up on.
+        if (!ticking)
+            last = now;
+        ticking = true;
+        float dt = std::chrono::duration<float>(now - last).count();
+        last = now;
+
+        unsigned int frame = physics->frame;
+        physics->step(dt);
+        physics->updateBodies();
+
+        const bool despawned = !physics->despawned.empty();
+        if (despawned)
+        {
+            std::lock_guard<std::mutex> lock(graveyardMutex);
+            for (const auto &d : physics->despawned)
+                graveyard.push_back({d.entity, published + 1});
+            physics->despawned.clear();
+        }
+
+        if (physics->frame != frame || despawned)
+            publish();
+
+        auto tick = std::chrono::duration<float>(1.0f / physics->tickRate);
+        std::this_thread::sleep_until(now + std::chrono::duration_cast<clock::duration>(tick));
+    }
+
+    // Torn down where it was built, with the scheduler it installed.
+    physics.reset();
+}
+
+void GE::PhysicsThread::publish()
+{
+    TransformSnapshot &snapshot = buffers[back];
+    RenderTransforms &transforms = physics->transforms;
+
+    // This buffer still holds what it was last published with, catch up on
+    // the slots allocated, written or released since. Merged statics keep
+    // their slots and are drawn from them, they never move.
+    const std::uint64_t since = snapshot.version;
+    snapshot.version = ++transforms.version;
+    snapshot.entries.resize(transforms.current.size());
+    for (std::size_t slot = 0; slot < snapshot.entries.size(); ++slot)
+    {
+        if (transforms.versions[slot] < since)
+            continue;
+        TransformSnapshot::Entry &entry = snapshot.entries[slot];
+        Entity *e = transforms.owners[slot];
+        if (!e || !e->model)
+        {
+            entry.entity = nullptr;
+            continue;
+        }
+        entry = {e, e->model, transforms.previous[slot], transforms.current[slot], transforms.scales[slot], transforms.models[slot], transforms.ticks[slot]};
+    }
+    snapshot.time = std::chrono::steady_clock::now();
+    snapshot.frame = physics->frame;
+    if (physics->profile)
+        snapshot.stats = physics->stats;
+    snapshot.sequence = ++published;
+
+    back = middle.exchange(back | DIRTY) & ~DIRTY;
+}
+
+const GE::TransformSnapshot &GE::PhysicsThread::acquire()
+{
+    if (middle.load() & DIRTY)
+        front = middle.exchange(front) & ~DIRTY;
+    return buffers[front];
+}
+
+void GE::PhysicsThread::collectDespawned(const TransformSnapshot &snapshot, std::vector<Entity *> &out)
+{
+    std::lock_guard<std::mutex> lock(graveyardMutex);
+    for (std::size_t i = 0; i < graveyard.size();)
+    {
+        if (graveyard[i].sequence <= snapshot.sequence)
+        {
+            out.push_back(graveyard[i].entity);
+            graveyard[i] = graveyard.back();
+            graveyard.pop_back();
+        }
+        else
+            ++i;
+    }
+}
+
+float GE::PhysicsThread::getInterpolationAlpha(const TransformSnapshot &snapshot) const
+{
+    float since = std::chrono::duration<float>(std::chrono::steady_clock::now() - snapshot.time).count();
+    float alpha = since * physics->tickRate;
+    return alpha < 0.0f ? 0.0f : (alpha > 1.0f ? 1.0f : alpha);
+}
@@ -0,0 +1,133 @@
+#ifndef PHYSICSTHREAD_HPP
+#define PHYSICSTHREAD_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <btBulletDynamicsCommon.h>
+
+#include "Physics.hpp"
+#include "EntityManager.hpp"
+
+namespace GE
+{
+    // Everything the renderer needs from one physics tick.
+    struct TransformSnapshot
+    {
+        // One per RenderTransforms slot.
+        struct Entry
+        {
+            Entity *entity = nullptr;   // nullptr for a free slot, or nothing to draw
+            const Model *model;
+            btTransform previous;
+            btTransform current;
+            glm::vec3 scale;
+            glm::mat4 modelMatrix;      // of `current`, built by RenderTransforms::write
+            unsigned int tick;          // of the last write, only a slot written at `frame` is blended
+        };
+
+        std::vector<Entry> entries;
+        // When `current` was produced, used to interpolate towards the next tick.
+        std::chrono::steady_clock::time_point time;
+        unsigned int frame = 0;
+        // Counts publishes, a snapshot can be republished without a new tick.
+        unsigned int sequence = 0;
+        // Of the step that produced it, left empty unless Physics::profile is set.
+        PhysicsStats stats;
+        // First RenderTransforms::version not copied in yet.
+        std::uint64_t version = 0;
+    };
+
+    // Builds a Physics and runs its step and updateBodies on a thread of its own.
+    //
+    // After every tick the body transforms are published into a snapshot.
+    // Snapshots are triple buffered: the physics thread always owns one slot,
+    // the render thread another, and the third is swapped with a single atomic
+    // exchange, so neither side ever waits for the other. A buffer keeps its
+    // entries between publishes and only the render slots written since it was
+    // last published are copied in again, static and sleeping bodies cost nothing.
+    //
+    // Bullet's task scheduler is process wide and has to be driven from the
+    // thread that installed it, the one Physics is built on. So the worker
+    // thread is started by the constructor, builds Physics itself and lives
+    // until the destructor: stop() and start() only pause and resume ticking.
+    // The Mt world and the query batches then run from the thread that owns
+    // the scheduler.
+    //
+    // While the thread is running nothing but the thread may touch Physics or
+    // entity bodies. Spawns and removals go through enqueue(), work that has to
+    // finish first through call(). While stopped the owner may set the world up
+    // directly, as long as nothing it does runs on the scheduler.
+    struct PhysicsThread
+    {
+        using Command = std::function<void(Physics &)>;
+
+        // Returns once Physics has been built on the worker.
+        explicit PhysicsThread(PhysicsConfig config = {});
+        PhysicsThread(const PhysicsThread &) = delete;
+        PhysicsThread &operator=(const PhysicsThread &) = delete;
+        ~PhysicsThread();
+
+        Physics &get() { return *physics; }
+
+        void start();
+        // Returns once the tick in flight is done.
+        void stop();
+        bool isRunning() const { return running; }
+
+        // Runs on the physics thread before its next tick, or right away when stopped.
+        void enqueue(Command command);
+        // Same, and waits for it. Not from a command.
+        void call(const Command &command);
+
+        // Latest published snapshot. Render thread only; the reference is valid
+        // until the next call.
+        const TransformSnapshot &acquire();
+        // Blend factor between previous and current for a snapshot drawn now.
+        float getInterpolationAlpha(const TransformSnapshot &snapshot) const;
+        // Entities despawned before `snapshot` was published. Neither that
+        // snapshot nor the collision events dispatched with it refer to them,
+        // so the render thread can delete them after dispatching.
+        void collectDespawned(const TransformSnapshot &snapshot, std::vector<Entity *> &out);
+
+    private:
+        std::unique_ptr<Physics> physics;
+        std::atomic<bool> running{false};
+        bool quit = false;
+
+        std::mutex commandMutex;
+        std::condition_variable wake;
+        std::vector<Command> commands;
+        std::vector<Command> executing;
+
+        static constexpr int DIRTY = 4;
+        TransformSnapshot buffers[3];
+        int back = 0;
+        int front = 1;
+        std::atomic<int> middle{2};
+        unsigned int published = 0;
+
+        struct Grave
+        {
+            Entity *entity;
+            unsigned int sequence;  // first snapshot without it
+        };
+        std::mutex graveyardMutex;
+        std::vector<Grave> graveyard;
+
+        // Last, started once everything above is constructed.
+        std::thread worker;
+
+        void run(PhysicsConfig config);
+        void publish();
+    };
+} // namespace GE
+
+#endif
@@ -4,38 +4,81 @@
 GE::Render::Render(EntityManager &entMan, int _w, int _h) : src_W{_w}, src_H{_h}, entityManager{entMan} {}
 //
 
-void GE::Render::RenderScene(Shader *shader, Camera &camera, Light &light) const
+void GE::Render::prepareFrame()
 {
+    drawList.clear();
+    if (snapshot)
+    {
+        for (const auto &entry : snapshot->entries)
+        {
+            if (!entry.entity)
+                continue;
+            // Only what moved during the last tick is blended, the rest uses the matrix physics built.
+            if (entry.tick != snapshot->frame || interpolation >= 1.0f)
+                drawList.push_back({entry.entity, entry.model, entry.modelMatrix});
+            else
+                drawList.push_back({entry.entity, entry.model, RenderTransforms::ToModelMatrix(InterpolateTransform(entry.previous, entry.current, interpolation), entry.scale)});
+        }
+        return;
+    }
+
     for (const auto e : entityManager.Entities)
     {
-        DrawEntity(e, shader, camera, light);
+        // TODO: Draw MODELS WITH NO PHYSICALS
+        if (e /* && e->body */ && e->model && e->transforms)
+        {
+            e->syncTransform();
+            drawList.push_back({e, e->model, e->getRenderMatrix(interpolation)});
+        }
     }
 }
 
-void GE::Render::DrawEntity(Entity *e, Shader *shader, Camera &camera, Light &light) const
+void GE::Render::RenderScene(Shader *shader, Camera &camera, Light &light) const
 {
-    glm::mat4 view = camera.GetViewMatrix();
-    glm::mat4 projection = camera.GetProjectionMatrix(src_W, src_H);
+    if (terrain)
+    {
+        SetupShader(shader, terrain->getModelMatrix(), camera, light);
+        shader->setInt("drawId", 3535);
+        terrain->Draw(*shader);
+    }
 
-    // TODO: Draw MODELS WITH NO PHYSICALS
-    if (e /* && e->body */ && e->model)
+    if (particles)
     {
-        static Shader* redShader = new Shader("shaders/vertexshader.vs", "shaders/redColorFragmentShader.fs");
-        e->updateModelTransform();
-        if(e->selected)
-            shader =  redShader;
-
-        shader->use();
-        shader->setInt  ("objectId", e->m_id);
-        shader->setInt  ("drawId", e->selected? 5353 : 3535);
-        shader->setVec2("resolution", glm::vec2(src_W, src_H));
-        shader->setVec3("lightPos", light.mPosition);
-        shader->setVec3("viewPos", camera.Position);
-        shader->setMat4("projection", projection);
-        shader->setMat4("view", view);
-        shader->setMat4("model", e->getModelTransformationMatrix());
-        shader->setMat4("lightSpaceMatrix", light.getSpaceMatrix());
-
-        e->model->Draw(*shader);
+        // Not pickable, pickEntity() only takes drawId 3535.
+        SetupShader(shader, glm::mat4(1.0f), camera, light);
+        shader->setInt("objectId", 0);
+        shader->setInt("drawId", 0);
+        particles->Draw(*shader);
     }
+
+    for (const auto &item : drawList)
+        DrawEntity(item.entity, item.model, item.modelMatrix, shader, camera, light);
+}
+
+void GE::Render::DrawEntity(Entity *e, const Model *model, const glm::mat4 &modelMatrix, Shader *shader, Camera &camera, Light &light) const
+{
+    static Shader* redShader = new Shader("shaders/vertexshader.vs", "shaders/redColorFragmentShader.fs");
+    if(e->selected)
+        shader =  redShader;
+
+    SetupShader(shader, modelMatrix, camera, light);
+    shader->setInt  ("objectId", e->m_id);
+    shader->setInt  ("drawId", e->selected? 5353 : 3535);
+
+    model->Draw(*shader);
+}
+
+void GE::Render::SetupShader(Shader *shader, const glm::mat4 &modelMatrix, Camera &camera, Light &light) const
+{
+    glm::mat4 view = camera.GetViewMatrix();
+    glm::mat4 projection = camera.GetProjectionMatrix(src_W, src_H);
+
+    shader->use();
+    shader->setVec2("resolution", glm::vec2(src_W, src_H));
+    shader->setVec3("lightPos", light.mPosition);
+    shader->setVec3("viewPos", camera.Position);
+    shader->setMat4("projection", projection);
+    shader->setMat4("view", view);
+    shader->setMat4("model", modelMatrix);
+    shader->setMat4("lightSpaceMatrix", light.getSpaceMatrix());
 }
\ No newline at end of file
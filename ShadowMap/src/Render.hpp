@@ -1,6 +1,8 @@
 #ifndef RENDER_HPP
 #define RENDER_HPP
 
+#include <vector>
+
 #include <glm/glm.hpp>
 
 #include "Model.hpp"
@@ -12,6 +14,9 @@
 #include "Light.hpp"
 #include "EntityManager.hpp"
 #include "Entity.hpp"
+#include "PhysicsThread.hpp"
+#include "TerrainMesh.hpp"
+#include "ParticleRenderer.hpp"
 
 namespace GE
 {
@@ -21,13 +26,38 @@ namespace GE
         Render() = delete;
         Render(EntityManager &entMan, int _w, int _h);
 
+        // Model matrices of every entity for this frame, blended once and shared
+        // by all the RenderScene() passes. After the snapshot and interpolation are set.
+        void prepareFrame();
         void RenderScene(Shader *shader, Camera &camera, Light &light) const;
+        // Set once per frame from Physics::getInterpolationAlpha()
+        void setInterpolation(float alpha) { interpolation = alpha; }
+        // With physics on its own thread, draw from its snapshot instead of reading
+        // the bodies. nullptr goes back to the entity list.
+        void useSnapshot(const TransformSnapshot *_snapshot) { snapshot = _snapshot; }
+        // Drawn before the entities in every pass, nullptr for none.
+        void setTerrain(const TerrainMesh *_terrain) { terrain = _terrain; }
+        // Debris particles, drawn after the terrain, nullptr for none.
+        void setParticles(const ParticleRenderer *_particles) { particles = _particles; }
 
     private:
+        struct DrawItem
+        {
+            Entity *entity;
+            const Model *model;
+            glm::mat4 modelMatrix;
+        };
+
         int src_W, src_H;
+        float interpolation = 1.0f;
+        const TransformSnapshot *snapshot = nullptr;
+        const TerrainMesh *terrain = nullptr;
+        const ParticleRenderer *particles = nullptr;
         EntityManager &entityManager;
+        std::vector<DrawItem> drawList;
 
-        void DrawEntity(Entity *e, Shader *shader, Camera &camera, Light &light) const;
+        void SetupShader(Shader *shader, const glm::mat4 &modelMatrix, Camera &camera, Light &light) const;
+        void DrawEntity(Entity *e, const Model *model, const glm::mat4 &modelMatrix, Shader *shader, Camera &camera, Light &light) const;
     };
 } // namespace GE
 
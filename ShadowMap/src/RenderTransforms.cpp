@@ -0,0 +1,104 @@
+#include "RenderTransforms.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "EntityManager.hpp"
+
+unsigned int GE::RenderTransforms::allocate(const btTransform &t, glm::vec3 scale, Entity *owner)
+{
+    unsigned int slot;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        slot = current.size();
+        models.emplace_back();
+        previous.emplace_back();
+        current.emplace_back();
+        scales.emplace_back();
+        ticks.emplace_back();
+        dirty.emplace_back();
+        owners.emplace_back();
+        versions.emplace_back();
+    }
+
+    previous[slot] = t;
+    current[slot] = t;
+    scales[slot] = scale;
+    models[slot] = ToModelMatrix(t, scale);
+    ticks[slot] = tick;
+    dirty[slot] = 1;
+    owners[slot] = owner;
+    versions[slot] = version;
+    return slot;
+}
+
+void GE::RenderTransforms::release(unsigned int slot)
+{
+    owners[slot] = nullptr;
+    versions[slot] = version;
+    freeSlots.push_back(slot);
+}
+
+void GE::RenderTransforms::reserve(std::size_t count)
+{
+    if (count <= freeSlots.size())
+        return;
+    const std::size_t n = current.size() + count - freeSlots.size();
+    models.reserve(n);
+    previous.reserve(n);
+    current.reserve(n);
+    scales.reserve(n);
+    ticks.reserve(n);
+    dirty.reserve(n);
+    owners.reserve(n);
+    versions.reserve(n);
+}
+
+void GE::RenderTransforms::write(unsigned int slot, const btTransform &t)
+{
+    // A slot that was not written for a while did not move, so current is
+    // still the state of the previous tick either way.
+    previous[slot] = current[slot];
+    current[slot] = t;
+    models[slot] = ToModelMatrix(t, scales[slot]);
+    ticks[slot] = tick;
+    dirty[slot] = 1;
+    versions[slot] = version;
+}
+
+void GE::RenderTransforms::reset(unsigned int slot, const btTransform &t)
+{
+    write(slot, t);
+    previous[slot] = t;
+}
+
+const btTransform &GE::RenderTransforms::getPrevious(unsigned int slot) const
+{
+    return ticks[slot] == tick ? previous[slot] : current[slot];
+}
+
+btTransform GE::RenderTransforms::getInterpolated(unsigned int slot, float alpha) const
+{
+    if (ticks[slot] != tick)
+        return current[slot];
+    return InterpolateTransform(previous[slot], current[slot], alpha);
+}
+
+glm::mat4 GE::RenderTransforms::getModelMatrix(unsigned int slot, float alpha) const
+{
+    if (ticks[slot] != tick || alpha >= 1.0f)
+        return models[slot];
+    return ToModelMatrix(InterpolateTransform(previous[slot], current[slot], alpha), scales[slot]);
+}
+
+glm::mat4 GE::RenderTransforms::ToModelMatrix(const btTransform &t, glm::vec3 scale)
+{
+    btScalar m[16];
+    t.getOpenGLMatrix(m);
+    return glm::scale(glm::make_mat4(m), scale);
+}
@@ -0,0 +1,71 @@
+#ifndef RENDERTRANSFORMS_HPP
+#define RENDERTRANSFORMS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <btBulletDynamicsCommon.h>
+
+namespace GE
+{
+    struct Entity;
+
+    // Render side copy of every body transform, one slot per entity, kept in
+    // contiguous arrays. Slots are only written through RenderMotionState, which
+    // Bullet calls for active bodies alone: static and sleeping bodies cost
+    // nothing per frame, their cached model matrix is simply reused.
+    struct RenderTransforms
+    {
+        std::vector<glm::mat4> models;      // final model matrix, scale included
+        std::vector<btTransform> previous;  // transform before the last write
+        std::vector<btTransform> current;
+        std::vector<glm::vec3> scales;
+        std::vector<unsigned int> ticks;    // tick of the last write
+        std::vector<std::uint8_t> dirty;    // set on write, cleared by the consumer
+        std::vector<Entity *> owners;       // nullptr for a free slot
+        std::vector<std::uint64_t> versions; // `version` at the last allocate, write or release
+
+        // Current physics tick, set by Physics before stepping.
+        unsigned int tick = 0;
+        // Bumped by a consumer that copies the slots out, which then only has to
+        // copy the slots stamped with a version it has not seen, see PhysicsThread::publish.
+        std::uint64_t version = 0;
+
+        unsigned int allocate(const btTransform &t, glm::vec3 scale, Entity *owner);
+        void release(unsigned int slot);
+        // Room for `count` more slots without reallocating.
+        void reserve(std::size_t count);
+        void write(unsigned int slot, const btTransform &t);
+        // Jump to `t` without blending from the old transform.
+        void reset(unsigned int slot, const btTransform &t);
+
+        // Slots not written during the last tick are at rest: previous is current.
+        const btTransform &getPrevious(unsigned int slot) const;
+        btTransform getInterpolated(unsigned int slot, float alpha) const;
+        glm::mat4 getModelMatrix(unsigned int slot, float alpha) const;
+
+        std::size_t size() const { return current.size() - freeSlots.size(); }
+
+        static glm::mat4 ToModelMatrix(const btTransform &t, glm::vec3 scale);
+
+    private:
+        std::vector<unsigned int> freeSlots;
+    };
+
+    // Motion state that forwards every transform Bullet publishes straight into
+    // a RenderTransforms slot.
+    struct RenderMotionState : public btMotionState
+    {
+        RenderMotionState(RenderTransforms &_transforms, unsigned int _slot) : transforms{_transforms}, slot{_slot} {}
+
+        void getWorldTransform(btTransform &worldTrans) const override { worldTrans = transforms.current[slot]; }
+        void setWorldTransform(const btTransform &worldTrans) override { transforms.write(slot, worldTrans); }
+
+        RenderTransforms &transforms;
+        unsigned int slot;
+    };
+} // namespace GE
+
+#endif
@@ -0,0 +1,229 @@
+#include "ShapeCache.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <BulletCollision/CollisionShapes/btOptimizedBvh.h>
+
+// Vertices are stored as floats and handed to Bullet in place.
+static_assert(sizeof(btScalar) == sizeof(float), "ShapeCache expects a single precision Bullet build");
+
+namespace
+{
+    constexpr char MAGIC[4] = {'G', 'E', 'S', 'C'};
+    // 2: hull inertia about the shape origin instead of the centre of mass.
+    // The serialized BVH layout belongs to the Bullet build, a different
+    // Bullet version must not map it.
+    constexpr std::uint32_t VERSION = 2u << 16 | BT_BULLET_VERSION;
+
+    // 32 bytes, so the payload of a mapped file starts 16 byte aligned.
+    struct FileHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t kind;
+        std::uint32_t reserved;
+        std::uint64_t hash;
+        std::uint64_t payloadSize;
+    };
+    static_assert(sizeof(FileHeader) == 32);
+} // namespace
+
+GE::ShapeCache::ShapeCache(std::string _directory) : directory{std::move(_directory)} {}
+
+GE::ShapeCache::~ShapeCache()
+{
+    for (auto &[key, mesh] : meshes)
+    {
+        delete mesh.shape;
+        delete mesh.mesh;
+    }
+    for (auto &[payload, mapping] : mappings)
+        munmap(mapping.base, mapping.length);
+}
+
+std::uint64_t GE::ShapeCache::Hash(const void *data, std::size_t size, std::uint64_t seed)
+{
+    std::uint64_t h = seed;
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i)
+        h = (h ^ bytes[i]) * 1099511628211ull;
+    return h;
+}
+
+std::string GE::ShapeCache::pathFor(const std::string &key, std::uint64_t hash) const
+{
+    std::string name = key;
+    for (char &c : name)
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '.')
+            c = '_';
+
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%016llx.shape", static_cast<unsigned long long>(hash));
+    return directory + "/" + name + suffix;
+}
+
+const char *GE::ShapeCache::map(const std::string &key, std::uint64_t hash, Kind kind, std::size_t &size, bool writable)
+{
+    if (!enabled())
+        return nullptr;
+
+    int fd = open(pathFor(key, hash).c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(FileHeader))
+        base = mmap(nullptr, st.st_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return nullptr;
+
+    const FileHeader *header = static_cast<const FileHeader *>(base);
+    if (std::memcmp(header->magic, MAGIC, 4) != 0 || header->version != VERSION ||
+        header->kind != static_cast<std::uint32_t>(kind) || header->hash != hash ||
+        header->payloadSize > st.st_size - sizeof(FileHeader))
+    {
+        munmap(base, st.st_size);
+        return nullptr;
+    }
+
+    const char *payload = static_cast<const char *>(base) + sizeof(FileHeader);
+    mappings[payload] = {base, static_cast<std::size_t>(st.st_size)};
+    size = header->payloadSize;
+    return payload;
+}
+
+void GE::ShapeCache::unmap(const char *payload)
+{
+    auto it = mappings.find(payload);
+    if (it == mappings.end())
+        return;
+    munmap(it->second.base, it->second.length);
+    mappings.erase(it);
+}
+
+bool GE::ShapeCache::store(const std::string &key, std::uint64_t hash, Kind kind, const std::vector<char> &payload)
+{
+    if (!enabled())
+        return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // Written next to the final name and renamed, so a reader never maps half a file.
+    const std::string path = pathFor(key, hash);
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        FileHeader header{{MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]}, VERSION, static_cast<std::uint32_t>(kind), 0, hash, payload.size()};
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(payload.data(), payload.size());
+        if (!out)
+        {
+            std::printf("could not write shape cache %s\n", temporary.c_str());
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    return !error;
+}
+
+btBvhTriangleMeshShape *GE::ShapeCache::getTriangleMesh(const std::string &key, const std::vector<float> &vertices, const std::vector<int> &indices)
+{
+    // The same key can come back with other geometry, e.g. another mergeStatics().
+    const std::uint64_t hash = Hash(indices.data(), indices.size() * sizeof(int), Hash(vertices.data(), vertices.size() * sizeof(float)));
+    const std::string meshKey = key + '#' + std::to_string(hash);
+    auto it = meshes.find(meshKey);
+    if (it != meshes.end())
+        return it->second.shape;
+
+    TriangleMesh &entry = meshes[meshKey];
+    if (btBvhTriangleMeshShape *shape = loadTriangleMesh(key, hash, entry))
+        return shape;
+
+    entry.vertices = vertices;
+    entry.indices = indices;
+    entry.mesh = new btTriangleIndexVertexArray(int(indices.size() / 3), entry.indices.data(), 3 * sizeof(int),
+                                                int(vertices.size() / 3), entry.vertices.data(), 3 * sizeof(float));
+    entry.shape = new btBvhTriangleMeshShape(entry.mesh, true, true);
+
+    if (enabled())
+    {
+        btOptimizedBvh *bvh = entry.shape->getOptimizedBvh();
+        const unsigned int bvhSize = bvh->calculateSerializeBufferSize();
+        const btVector3 &aabbMin = entry.shape->getLocalAabbMin();
+        const btVector3 &aabbMax = entry.shape->getLocalAabbMax();
+
+        Writer w;
+        w.put(std::uint32_t(vertices.size() / 3));
+        w.put(std::uint32_t(indices.size()));
+        w.put(aabbMin);
+        w.put(aabbMax);
+        w.put(std::uint64_t(bvhSize));
+        w.align(16);
+        w.put(vertices.data(), vertices.size() * sizeof(float));
+        w.align(16);
+        w.put(indices.data(), indices.size() * sizeof(int));
+        w.align(16);
+
+        // serializeInPlace needs an aligned buffer of its own.
+        void *buffer = btAlignedAlloc(bvhSize, 16);
+        bvh->serializeInPlace(buffer, bvhSize, false);
+        w.put(buffer, bvhSize);
+        btAlignedFree(buffer);
+
+        store(key, hash, Kind::TriangleMesh, w.bytes);
+    }
+    return entry.shape;
+}
+
+btBvhTriangleMeshShape *GE::ShapeCache::loadTriangleMesh(const std::string &key, std::uint64_t hash, TriangleMesh &out)
+{
+    std::size_t size;
+    // The BVH is patched in place on load (vtable, pointers), hence writable.
+    const char *payload = map(key, hash, Kind::TriangleMesh, size, true);
+    if (!payload)
+        return nullptr;
+
+    Reader r{payload, size};
+    std::uint32_t numVertices, numIndices;
+    btVector3 aabbMin, aabbMax;
+    std::uint64_t bvhSize;
+    bool ok = r.get(numVertices) && r.get(numIndices) && r.get(aabbMin) && r.get(aabbMax) && r.get(bvhSize);
+    r.align(16);
+    const char *vertices = ok ? r.skip(numVertices * 3 * sizeof(float)) : nullptr;
+    r.align(16);
+    const char *indices = vertices ? r.skip(numIndices * sizeof(int)) : nullptr;
+    r.align(16);
+    const char *bvhData = indices ? r.skip(bvhSize) : nullptr;
+    if (!bvhData)
+    {
+        unmap(payload);
+        return nullptr;
+    }
+
+    out.mesh = new btTriangleIndexVertexArray(int(numIndices / 3), reinterpret_cast<int *>(const_cast<char *>(indices)), 3 * sizeof(int),
+                                              int(numVertices), reinterpret_cast<btScalar *>(const_cast<char *>(vertices)), 3 * sizeof(float));
+    btOptimizedBvh *bvh = static_cast<btOptimizedBvh *>(btOptimizedBvh::deSerializeInPlace(const_cast<char *>(bvhData), static_cast<unsigned int>(bvhSize), false));
+    out.shape = new btBvhTriangleMeshShape(out.mesh, true, aabbMin, aabbMax, false);
+    // Not owned by the shape, it lives in the mapping until the cache goes away.
+    out.shape->setOptimizedBvh(bvh);
+    return out.shape;
+}
+
+bool GE::ShapeCache::owns(const btCollisionShape *shape) const
+{
+    for (const auto &[key, mesh] : meshes)
+        if (mesh.shape == shape)
+            return true;
+    return false;
+}
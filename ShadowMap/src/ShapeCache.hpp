@@ -0,0 +1,125 @@
+#ifndef SHAPECACHE_HPP
+#define SHAPECACHE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <btBulletDynamicsCommon.h>
+
+namespace GE
+{
+    // Cooked collision shapes on disk, one file per key and content hash:
+    // <directory>/<key>-<hash>.shape. A file whose header does not match the
+    // expected kind and hash is ignored and rewritten, so editing a model
+    // simply produces a new file.
+    //
+    // Files are memory mapped. Hulls are copied out and unmapped right away;
+    // triangle mesh BVHs are stored in btOptimizedBvh's in-place format and
+    // used straight from the mapping, so loading one costs a page fault per
+    // touched page instead of a rebuild.
+    struct ShapeCache
+    {
+        enum class Kind : std::uint32_t
+        {
+            Hull,
+            Compound,
+            TriangleMesh
+        };
+
+        // Appends plain values to a payload.
+        struct Writer
+        {
+            std::vector<char> bytes;
+
+            template <class T>
+            void put(const T &value)
+            {
+                const char *p = reinterpret_cast<const char *>(&value);
+                bytes.insert(bytes.end(), p, p + sizeof(T));
+            }
+            void put(const void *data, std::size_t size)
+            {
+                const char *p = static_cast<const char *>(data);
+                bytes.insert(bytes.end(), p, p + size);
+            }
+            void align(std::size_t alignment) { bytes.resize((bytes.size() + alignment - 1) / alignment * alignment); }
+        };
+
+        // Reads them back, failing instead of running past the end.
+        struct Reader
+        {
+            const char *data;
+            std::size_t size;
+            std::size_t offset = 0;
+
+            template <class T>
+            bool get(T &value)
+            {
+                if (offset + sizeof(T) > size)
+                    return false;
+                std::memcpy(&value, data + offset, sizeof(T));
+                offset += sizeof(T);
+                return true;
+            }
+            const char *skip(std::size_t bytes)
+            {
+                if (offset + bytes > size)
+                    return nullptr;
+                const char *p = data + offset;
+                offset += bytes;
+                return p;
+            }
+            void align(std::size_t alignment) { offset = (offset + alignment - 1) / alignment * alignment; }
+        };
+
+        // Empty directory: nothing is read or written.
+        explicit ShapeCache(std::string directory = "");
+        ShapeCache(const ShapeCache &) = delete;
+        ShapeCache &operator=(const ShapeCache &) = delete;
+        ~ShapeCache();
+
+        bool enabled() const { return !directory.empty(); }
+        std::string pathFor(const std::string &key, std::uint64_t hash) const;
+
+        // Payload of a cached shape, or null. Writable mappings are private
+        // (copy on write), the file never changes.
+        const char *map(const std::string &key, std::uint64_t hash, Kind kind, std::size_t &size, bool writable = false);
+        void unmap(const char *payload);
+        bool store(const std::string &key, std::uint64_t hash, Kind kind, const std::vector<char> &payload);
+
+        // Static mesh with a quantized BVH, built once and mapped on later runs.
+        // `indices` holds three per triangle. The shape is owned by the cache.
+        btBvhTriangleMeshShape *getTriangleMesh(const std::string &key, const std::vector<float> &vertices, const std::vector<int> &indices);
+        bool owns(const btCollisionShape *shape) const;
+
+        // FNV-1a, chain calls through `seed` to hash several buffers.
+        static std::uint64_t Hash(const void *data, std::size_t size, std::uint64_t seed = 14695981039346656037ull);
+
+    private:
+        struct Mapping
+        {
+            void *base;
+            std::size_t length;
+        };
+
+        struct TriangleMesh
+        {
+            btBvhTriangleMeshShape *shape;
+            btTriangleIndexVertexArray *mesh;
+            std::vector<float> vertices;
+            std::vector<int> indices;
+        };
+
+        std::string directory;
+        std::unordered_map<const char *, Mapping> mappings;
+        // By key and content hash, "key#hash".
+        std::unordered_map<std::string, TriangleMesh> meshes;
+
+        btBvhTriangleMeshShape *loadTriangleMesh(const std::string &key, std::uint64_t hash, TriangleMesh &out);
+    };
+} // namespace GE
+
+#endif
@@ -0,0 +1,90 @@
+#include "ShapeRegistry.hpp"
+
+#include <functional>
+
+GE::ShapeRegistry::~ShapeRegistry()
+{
+    for (auto &[key, entry] : shapes)
+        delete entry.shape;
+}
+
+std::size_t GE::ShapeRegistry::KeyHash::operator()(const Key &k) const
+{
+    std::size_t h = std::hash<float>{}(k.x);
+    h ^= std::hash<float>{}(k.y) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= std::hash<float>{}(k.z) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= static_cast<std::size_t>(k.type) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+}
+
+btCollisionShape *GE::ShapeRegistry::acquire(const Key &key)
+{
+    auto it = shapes.find(key);
+    if (it != shapes.end())
+    {
+        ++it->second.refs;
+        return it->second.shape;
+    }
+
+    btCollisionShape *shape = nullptr;
+    switch (key.type)
+    {
+    case ShapeType::Sphere:
+        shape = new btSphereShape(key.x);
+        break;
+    case ShapeType::Box:
+        shape = new btBoxShape(btVector3(key.x, key.y, key.z));
+        break;
+    case ShapeType::Box2D:
+        shape = new btBox2dShape(btVector3(key.x, key.y, key.z));
+        break;
+    }
+
+    shapes.emplace(key, Entry{shape, 1});
+    keys.emplace(shape, key);
+    return shape;
+}
+
+btSphereShape *GE::ShapeRegistry::getSphere(float radius)
+{
+    return static_cast<btSphereShape *>(acquire({ShapeType::Sphere, radius, 0.0f, 0.0f}));
+}
+
+btBoxShape *GE::ShapeRegistry::getBox(const glm::vec3 halfExtents)
+{
+    return static_cast<btBoxShape *>(acquire({ShapeType::Box, halfExtents.x, halfExtents.y, halfExtents.z}));
+}
+
+btBox2dShape *GE::ShapeRegistry::getBox2D(const glm::vec2 dimensions)
+{
+    return static_cast<btBox2dShape *>(acquire({ShapeType::Box2D, dimensions.x, 0.0f, dimensions.y}));
+}
+
+bool GE::ShapeRegistry::release(const btCollisionShape *shape)
+{
+    auto k = keys.find(shape);
+    if (k == keys.end())
+        return false;
+
+    auto it = shapes.find(k->second);
+    if (--it->second.refs == 0)
+    {
+        delete it->second.shape;
+        shapes.erase(it);
+        keys.erase(k);
+    }
+    return true;
+}
+
+void GE::ShapeRegistry::retain(const btCollisionShape *shape, unsigned int count)
+{
+    auto k = keys.find(shape);
+    if (k != keys.end())
+        shapes.at(k->second).refs += count;
+}
+
+unsigned int GE::ShapeRegistry::refCount(const btCollisionShape *shape) const
+{
+    auto k = keys.find(shape);
+    return k == keys.end() ? 0 : shapes.at(k->second).refs;
+}
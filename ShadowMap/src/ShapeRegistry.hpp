@@ -0,0 +1,69 @@
+#ifndef SHAPEREGISTRY_HPP
+#define SHAPEREGISTRY_HPP
+
+#include <cstdint>
+#include <unordered_map>
+
+#include <btBulletDynamicsCommon.h>
+#include <BulletCollision/CollisionShapes/btBox2dShape.h>
+#include <glm/glm.hpp>
+
+namespace GE
+{
+    // Interns primitive collision shapes: every body of the same type and size
+    // shares one btCollisionShape. Shapes are reference counted, get*() adds a
+    // reference and release() drops it, deleting the shape with the last one.
+    struct ShapeRegistry
+    {
+        enum class ShapeType : std::uint8_t
+        {
+            Sphere,
+            Box,
+            Box2D
+        };
+
+        ShapeRegistry() = default;
+        ShapeRegistry(const ShapeRegistry &) = delete;
+        ShapeRegistry &operator=(const ShapeRegistry &) = delete;
+        ~ShapeRegistry();
+
+        btSphereShape *getSphere(float radius);
+        btBoxShape *getBox(const glm::vec3 halfExtents);
+        btBox2dShape *getBox2D(const glm::vec2 dimensions);
+
+        // Returns false when the shape was not created by this registry.
+        bool release(const btCollisionShape *shape);
+        // `count` more references to a shape returned by get*(), for bodies spawned in bulk.
+        void retain(const btCollisionShape *shape, unsigned int count);
+
+        std::size_t size() const { return shapes.size(); }
+        unsigned int refCount(const btCollisionShape *shape) const;
+
+    private:
+        struct Key
+        {
+            ShapeType type;
+            float x, y, z;
+
+            bool operator==(const Key &o) const { return type == o.type && x == o.x && y == o.y && z == o.z; }
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()(const Key &k) const;
+        };
+
+        struct Entry
+        {
+            btCollisionShape *shape;
+            unsigned int refs;
+        };
+
+        std::unordered_map<Key, Entry, KeyHash> shapes;
+        std::unordered_map<const btCollisionShape *, Key> keys;
+
+        btCollisionShape *acquire(const Key &key);
+    };
+} // namespace GE
+
+#endif
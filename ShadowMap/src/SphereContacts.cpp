@@ -0,0 +1,231 @@
+#include "SphereContacts.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+
+#include <BulletCollision/CollisionDispatch/btActivatingCollisionAlgorithm.h>
+#include <BulletCollision/CollisionShapes/btBox2dShape.h>
+
+namespace
+{
+    using Batch = GE::SphereContactDispatcher::Batch;
+
+    // Queues its manifold for Batch::flush() instead of computing contacts.
+    struct BatchedAlgorithm : public btActivatingCollisionAlgorithm
+    {
+        BatchedAlgorithm(const btCollisionAlgorithmConstructionInfo &ci, const btCollisionObjectWrapper *body0Wrap, const btCollisionObjectWrapper *body1Wrap, Batch &batch)
+            : btActivatingCollisionAlgorithm(ci, body0Wrap, body1Wrap), batch(batch)
+        {
+            const bool swapped = body0Wrap->getCollisionShape()->getShapeType() != SPHERE_SHAPE_PROXYTYPE;
+            sphere = (swapped ? body1Wrap : body0Wrap)->getCollisionObject();
+            other = (swapped ? body0Wrap : body1Wrap)->getCollisionObject();
+            sphereSphere = other->getCollisionShape()->getShapeType() == SPHERE_SHAPE_PROXYTYPE;
+            manifold = m_dispatcher->getNewManifold(body0Wrap->getCollisionObject(), body1Wrap->getCollisionObject());
+        }
+
+        ~BatchedAlgorithm() override
+        {
+            m_dispatcher->releaseManifold(manifold);
+        }
+
+        void processCollision(const btCollisionObjectWrapper *, const btCollisionObjectWrapper *, const btDispatcherInfo &, btManifoldResult *resultOut) override
+        {
+            resultOut->setPersistentManifold(manifold);
+            (sphereSphere ? batch.spheres : batch.boxes).push_back({manifold, sphere, other});
+        }
+
+        btScalar calculateTimeOfImpact(btCollisionObject *, btCollisionObject *, const btDispatcherInfo &, btManifoldResult *) override
+        {
+            return btScalar(1.);
+        }
+
+        void getAllContactManifolds(btManifoldArray &manifoldArray) override
+        {
+            manifoldArray.push_back(manifold);
+        }
+
+        Batch &batch;
+        btPersistentManifold *manifold;
+        const btCollisionObject *sphere;
+        const btCollisionObject *other;
+        bool sphereSphere;
+    };
+
+    // Whole bodies get the batched algorithm, compound children Bullet's own.
+    struct BatchedCreateFunc : public btCollisionAlgorithmCreateFunc
+    {
+        BatchedCreateFunc(Batch &batch, btCollisionAlgorithmCreateFunc *fallback) : batch(batch), fallback(fallback) {}
+
+        btCollisionAlgorithm *CreateCollisionAlgorithm(btCollisionAlgorithmConstructionInfo &ci, const btCollisionObjectWrapper *body0Wrap, const btCollisionObjectWrapper *body1Wrap) override
+        {
+            if (body0Wrap->m_parent || body1Wrap->m_parent)
+                return fallback->CreateCollisionAlgorithm(ci, body0Wrap, body1Wrap);
+            void *mem = ci.m_dispatcher1->allocateCollisionAlgorithm(sizeof(BatchedAlgorithm));
+            return new (mem) BatchedAlgorithm(ci, body0Wrap, body1Wrap, batch);
+        }
+
+        Batch &batch;
+        btCollisionAlgorithmCreateFunc *fallback;
+    };
+
+    btScalar Radius(const btCollisionObject *object)
+    {
+        return static_cast<const btSphereShape *>(object->getCollisionShape())->getRadius();
+    }
+
+    btVector3 HalfExtents(const btCollisionObject *object)
+    {
+        const btCollisionShape *shape = object->getCollisionShape();
+        if (shape->getShapeType() == BOX_2D_SHAPE_PROXYTYPE)
+            return static_cast<const btBox2dShape *>(shape)->getHalfExtentsWithMargin();
+        return static_cast<const btBoxShape *>(shape)->getHalfExtentsWithMargin();
+    }
+
+    // Same contact Bullet's sphere algorithms would add, through the same btManifoldResult.
+    void WriteContact(const Batch::Pair &p, const btVector3 &normalOnOther, const btVector3 &pointOnOther, btScalar distance, bool add)
+    {
+        btCollisionObjectWrapper sphereWrap(nullptr, p.sphere->getCollisionShape(), p.sphere, p.sphere->getWorldTransform(), -1, -1);
+        btCollisionObjectWrapper otherWrap(nullptr, p.other->getCollisionShape(), p.other, p.other->getWorldTransform(), -1, -1);
+        btManifoldResult result(&sphereWrap, &otherWrap);
+        result.setPersistentManifold(p.manifold);
+        if (add)
+            result.addContactPoint(normalOnOther, pointOnOther, distance);
+        result.refreshContactPoints();
+    }
+} // namespace
+
+GE::SphereContactDispatcher::SphereContactDispatcher(btCollisionConfiguration *configuration) : btCollisionDispatcher(configuration)
+{
+    const int others[] = {SPHERE_SHAPE_PROXYTYPE, BOX_SHAPE_PROXYTYPE, BOX_2D_SHAPE_PROXYTYPE};
+    for (int other : others)
+    {
+        createFuncs.push_back(new BatchedCreateFunc(batch, configuration->getCollisionAlgorithmCreateFunc(SPHERE_SHAPE_PROXYTYPE, other)));
+        registerCollisionCreateFunc(SPHERE_SHAPE_PROXYTYPE, other, createFuncs.back());
+        if (other == SPHERE_SHAPE_PROXYTYPE)
+            continue;
+        createFuncs.push_back(new BatchedCreateFunc(batch, configuration->getCollisionAlgorithmCreateFunc(other, SPHERE_SHAPE_PROXYTYPE)));
+        registerCollisionCreateFunc(other, SPHERE_SHAPE_PROXYTYPE, createFuncs.back());
+    }
+}
+
+GE::SphereContactDispatcher::~SphereContactDispatcher()
+{
+    for (btCollisionAlgorithmCreateFunc *f : createFuncs)
+        delete f;
+}
+
+void GE::SphereContactDispatcher::dispatchAllCollisionPairs(btOverlappingPairCache *pairCache, const btDispatcherInfo &dispatchInfo, btDispatcher *dispatcher)
+{
+    batch.spheres.clear();
+    batch.boxes.clear();
+    btCollisionDispatcher::dispatchAllCollisionPairs(pairCache, dispatchInfo, dispatcher);
+    lastSpheres = batch.spheres.size();
+    lastBoxes = batch.boxes.size();
+    batch.flush();
+}
+
+void GE::SphereContactDispatcher::Batch::flush()
+{
+    const std::size_t n = spheres.size() > boxes.size() ? spheres.size() : boxes.size();
+    for (auto *v : {&ax, &ay, &az, &ar, &bx, &by, &bz, &br, &hx, &hy, &hz, &nx, &ny, &nz, &px, &py, &pz, &dist})
+        v->resize(n);
+    for (auto &v : basis)
+        v.resize(n);
+
+    // The compute loops below vectorize (g++ -O3 -fopt-info-vec) as long as
+    // they stay free of branches: no conditional divide, selects only, and
+    // sqrt without errno, see CCFLAGS. ivdep because the buffers are separate
+    // vectors the compiler cannot prove apart.
+
+    // Sphere against sphere. Coincident centres get +x as the normal, as in btSphereSphereCollisionAlgorithm.
+    std::size_t count = spheres.size();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const btVector3 &a = spheres[i].sphere->getWorldTransform().getOrigin();
+        const btVector3 &b = spheres[i].other->getWorldTransform().getOrigin();
+        ax[i] = a.x(), ay[i] = a.y(), az[i] = a.z(), ar[i] = Radius(spheres[i].sphere);
+        bx[i] = b.x(), by[i] = b.y(), bz[i] = b.z(), br[i] = Radius(spheres[i].other);
+    }
+#pragma GCC ivdep
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const btScalar dx = ax[i] - bx[i], dy = ay[i] - by[i], dz = az[i] - bz[i];
+        const btScalar len = std::sqrt(dx * dx + dy * dy + dz * dz);
+        const bool apart = len > SIMD_EPSILON;
+        const btScalar inv = btScalar(1) / std::max(len, btScalar(SIMD_EPSILON));
+        nx[i] = apart ? dx * inv : btScalar(1);
+        ny[i] = apart ? dy * inv : btScalar(0);
+        nz[i] = apart ? dz * inv : btScalar(0);
+        px[i] = bx[i] + br[i] * nx[i];
+        py[i] = by[i] + br[i] * ny[i];
+        pz[i] = bz[i] + br[i] * nz[i];
+        dist[i] = len - ar[i] - br[i];
+    }
+    // Like Bullet, spheres only get a point once they touch.
+    for (std::size_t i = 0; i < count; ++i)
+        WriteContact(spheres[i], {nx[i], ny[i], nz[i]}, {px[i], py[i], pz[i]}, dist[i], dist[i] <= btScalar(0));
+
+    // Sphere against box: closest point of the box in its own frame, or the
+    // nearest face when the centre is inside.
+    count = boxes.size();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const btVector3 &a = boxes[i].sphere->getWorldTransform().getOrigin();
+        const btTransform &t = boxes[i].other->getWorldTransform();
+        const btVector3 h = HalfExtents(boxes[i].other);
+        ax[i] = a.x(), ay[i] = a.y(), az[i] = a.z(), ar[i] = Radius(boxes[i].sphere);
+        bx[i] = t.getOrigin().x(), by[i] = t.getOrigin().y(), bz[i] = t.getOrigin().z();
+        hx[i] = h.x(), hy[i] = h.y(), hz[i] = h.z();
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                basis[r * 3 + c][i] = t.getBasis()[r][c];
+    }
+    const btScalar *m0 = basis[0].data(), *m1 = basis[1].data(), *m2 = basis[2].data();
+    const btScalar *m3 = basis[3].data(), *m4 = basis[4].data(), *m5 = basis[5].data();
+    const btScalar *m6 = basis[6].data(), *m7 = basis[7].data(), *m8 = basis[8].data();
+#pragma GCC ivdep
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const btScalar dx = ax[i] - bx[i], dy = ay[i] - by[i], dz = az[i] - bz[i];
+        // Into box space, transposed basis.
+        const btScalar lx = m0[i] * dx + m3[i] * dy + m6[i] * dz;
+        const btScalar ly = m1[i] * dx + m4[i] * dy + m7[i] * dz;
+        const btScalar lz = m2[i] * dx + m5[i] * dy + m8[i] * dz;
+
+        const btScalar cx = std::min(std::max(lx, -hx[i]), hx[i]);
+        const btScalar cy = std::min(std::max(ly, -hy[i]), hy[i]);
+        const btScalar cz = std::min(std::max(lz, -hz[i]), hz[i]);
+        const btScalar ex = lx - cx, ey = ly - cy, ez = lz - cz;
+        const btScalar elen = std::sqrt(ex * ex + ey * ey + ez * ez);
+        const bool outside = elen > SIMD_EPSILON;
+        const btScalar inv = btScalar(1) / std::max(elen, btScalar(SIMD_EPSILON));
+
+        const btScalar sx = lx < 0 ? btScalar(-1) : btScalar(1);
+        const btScalar sy = ly < 0 ? btScalar(-1) : btScalar(1);
+        const btScalar sz = lz < 0 ? btScalar(-1) : btScalar(1);
+        const btScalar fx = hx[i] - std::fabs(lx), fy = hy[i] - std::fabs(ly), fz = hz[i] - std::fabs(lz);
+        const bool useX = (fx <= fy) & (fx <= fz);
+        const bool useY = !useX & (fy <= fz);
+        const bool useZ = !useX & !useY;
+
+        const btScalar lnx = outside ? ex * inv : (useX ? sx : btScalar(0));
+        const btScalar lny = outside ? ey * inv : (useY ? sy : btScalar(0));
+        const btScalar lnz = outside ? ez * inv : (useZ ? sz : btScalar(0));
+        const btScalar lpx = outside ? cx : (useX ? sx * hx[i] : lx);
+        const btScalar lpy = outside ? cy : (useY ? sy * hy[i] : ly);
+        const btScalar lpz = outside ? cz : (useZ ? sz * hz[i] : lz);
+        const btScalar face = std::min(std::min(fx, fy), fz);
+
+        nx[i] = m0[i] * lnx + m1[i] * lny + m2[i] * lnz;
+        ny[i] = m3[i] * lnx + m4[i] * lny + m5[i] * lnz;
+        nz[i] = m6[i] * lnx + m7[i] * lny + m8[i] * lnz;
+        px[i] = bx[i] + m0[i] * lpx + m1[i] * lpy + m2[i] * lpz;
+        py[i] = by[i] + m3[i] * lpx + m4[i] * lpy + m5[i] * lpz;
+        pz[i] = bz[i] + m6[i] * lpx + m7[i] * lpy + m8[i] * lpz;
+        dist[i] = (outside ? elen : -face) - ar[i];
+    }
+    // btManifoldResult drops what lies beyond the contact breaking threshold.
+    for (std::size_t i = 0; i < count; ++i)
+        WriteContact(boxes[i], {nx[i], ny[i], nz[i]}, {px[i], py[i], pz[i]}, dist[i], true);
+}
@@ -0,0 +1,67 @@
+#ifndef SPHERECONTACTS_HPP
+#define SPHERECONTACTS_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <btBulletDynamicsCommon.h>
+
+namespace GE
+{
+    // Dispatcher with a batched fast path for ball piles.
+    //
+    // Sphere-sphere and sphere-box pairs between whole bodies get an algorithm
+    // that does no work in processCollision(): it only queues its manifold.
+    // Once Bullet has visited every pair, the queued pairs are gathered into
+    // structure of arrays buffers and run through one branch free loop per
+    // pair type, which g++ -O3 vectorizes given the math flags in the Makefile,
+    // and the results are written back through btManifoldResult like Bullet's
+    // own sphere algorithms do. Gathering and writing back stay scalar.
+    //
+    // Pairs inside compounds keep Bullet's algorithms, their manifolds are
+    // managed by the compound and cannot wait until the end of the dispatch.
+    // Single threaded dispatch only.
+    struct SphereContactDispatcher : public btCollisionDispatcher
+    {
+        explicit SphereContactDispatcher(btCollisionConfiguration *configuration);
+        ~SphereContactDispatcher() override;
+
+        void dispatchAllCollisionPairs(btOverlappingPairCache *pairCache, const btDispatcherInfo &dispatchInfo, btDispatcher *dispatcher) override;
+
+        struct Batch
+        {
+            struct Pair
+            {
+                btPersistentManifold *manifold;
+                const btCollisionObject *sphere;
+                const btCollisionObject *other;
+            };
+
+            std::vector<Pair> spheres;   // sphere against sphere
+            std::vector<Pair> boxes;     // sphere against box or 2D box
+
+            // Structure of arrays, reused between dispatches.
+            std::vector<btScalar> ax, ay, az, ar;           // sphere centre and radius
+            std::vector<btScalar> bx, by, bz, br;           // other sphere, or box origin
+            std::vector<btScalar> basis[9];                 // box rotation, row major
+            std::vector<btScalar> hx, hy, hz;               // box half extents, with margin
+            std::vector<btScalar> nx, ny, nz;               // normal on the other body
+            std::vector<btScalar> px, py, pz;               // point on the other body
+            std::vector<btScalar> dist;                     // negative when penetrating
+
+            void flush();
+        };
+
+        // Pairs handled by the last dispatch.
+        std::size_t batchedSpheres() const { return lastSpheres; }
+        std::size_t batchedBoxes() const { return lastBoxes; }
+
+    private:
+        Batch batch;
+        std::vector<btCollisionAlgorithmCreateFunc *> createFuncs;
+        std::size_t lastSpheres = 0;
+        std::size_t lastBoxes = 0;
+    };
+} // namespace GE
+
+#endif
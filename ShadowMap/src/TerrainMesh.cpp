@@ -0,0 +1,149 @@
+#include "TerrainMesh.hpp"
+
+#include <algorithm>
+
+GE::TerrainMesh::TerrainMesh(const Heightfield &_field, glm::vec3 _origin, const std::string &_texture, int _chunkCells)
+    : field{_field}, origin{_origin}, texture{_texture, true}, chunkCells{_chunkCells}
+{
+    for (int z0 = 0; z0 < field.length - 1; z0 += chunkCells)
+        for (int x0 = 0; x0 < field.width - 1; x0 += chunkCells)
+        {
+            Chunk &c = chunks.emplace_back();
+            c.x0 = x0;
+            c.z0 = z0;
+            c.x1 = std::min(x0 + chunkCells, field.width - 1);
+            c.z1 = std::min(z0 + chunkCells, field.length - 1);
+            glm::vec3 a = field.position(c.x0, c.z0), b = field.position(c.x1, c.z1);
+            c.center = origin + glm::vec3{0.5f * (a.x + b.x), 0.5f * (field.minHeight + field.maxHeight), 0.5f * (a.z + b.z)};
+        }
+}
+
+GE::TerrainMesh::~TerrainMesh()
+{
+    for (Chunk &c : chunks)
+        unload(c);
+    glDeleteTextures(1, &texture.id);
+}
+
+void GE::TerrainMesh::update(const glm::vec3 &eye)
+{
+    int builds = 0;
+    for (Chunk &c : chunks)
+    {
+        float distance = glm::length(c.center - eye);
+        if (distance > unloadDistance)
+        {
+            unload(c);
+            continue;
+        }
+        if (distance > loadDistance && c.lod < 0)
+            continue;
+
+        int lod = 0;
+        while (lod + 1 < LODS && distance > lodDistance * (1 << lod))
+            ++lod;
+
+        if (!c.built[lod])
+        {
+            // Over budget: keep drawing whatever level is there, coarser or finer.
+            if (builds >= buildsPerFrame)
+                continue;
+            build(c, lod);
+            ++builds;
+        }
+        c.lod = lod;
+    }
+}
+
+void GE::TerrainMesh::Draw(Shader &shader) const
+{
+    shader.setInt("objectId", objectId);
+    for (const Chunk &c : chunks)
+        if (c.lod >= 0)
+            c.lods[c.lod].Draw(shader);
+}
+
+glm::mat4 GE::TerrainMesh::getModelMatrix() const
+{
+    return glm::translate(glm::mat4(1.0f), origin);
+}
+
+std::size_t GE::TerrainMesh::loadedChunks() const
+{
+    return std::count_if(chunks.begin(), chunks.end(), [](const Chunk &c)
+                         { return c.lod >= 0; });
+}
+
+void GE::TerrainMesh::build(Chunk &c, int lod)
+{
+    const int step = 1 << lod;
+    std::vector<int> xs, zs;
+    for (int x = c.x0; x < c.x1; x += step)
+        xs.push_back(x);
+    xs.push_back(c.x1);
+    for (int z = c.z0; z < c.z1; z += step)
+        zs.push_back(z);
+    zs.push_back(c.z1);
+
+    const unsigned int nx = xs.size(), nz = zs.size();
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    vertices.reserve(nx * nz + 2 * (nx + nz));
+    indices.reserve(6 * (nx - 1) * (nz - 1) + 24 * (nx + nz));
+
+    for (int z : zs)
+        for (int x : xs)
+        {
+            glm::vec3 p = field.position(x, z);
+            Vertex &v = vertices.emplace_back(p, glm::vec2{p.x, p.z} / textureSize);
+            v.Normal = field.normal(x, z);
+        }
+    for (unsigned int j = 0; j + 1 < nz; ++j)
+        for (unsigned int i = 0; i + 1 < nx; ++i)
+        {
+            unsigned int a = j * nx + i, b = a + 1, c2 = a + nx, d = c2 + 1;
+            indices.insert(indices.end(), {a, c2, b, b, c2, d});
+        }
+
+    // Skirt: the border, copied down by a couple of coarse cells and stitched
+    // to the edge with both windings, so it shows from either side.
+    const float drop = 2.0f * step * field.spacing + 0.05f * (field.maxHeight - field.minHeight);
+    auto skirt = [&](unsigned int from, unsigned int count, unsigned int stride)
+    {
+        for (unsigned int k = 0; k + 1 < count; ++k)
+        {
+            unsigned int a = from + k * stride, b = a + stride;
+            const glm::vec3 pa = vertices[a].Position, pb = vertices[b].Position;
+            Vertex va = vertices[a], vb = vertices[b];
+            va.Position = pa - glm::vec3{0, drop, 0};
+            vb.Position = pb - glm::vec3{0, drop, 0};
+            vertices.push_back(va);
+            vertices.push_back(vb);
+            unsigned int la = vertices.size() - 2, lb = vertices.size() - 1;
+            indices.insert(indices.end(), {a, la, b, b, la, lb, a, b, la, b, lb, la});
+        }
+    };
+    skirt(0, nx, 1);                // z0 edge
+    skirt((nz - 1) * nx, nx, 1);    // z1 edge
+    skirt(0, nz, nx);               // x0 edge
+    skirt(nx - 1, nz, nx);          // x1 edge
+
+    c.lods[lod] = Mesh(std::move(vertices), std::move(indices), {texture}, "terrain");
+    c.built[lod] = true;
+}
+
+void GE::TerrainMesh::unload(Chunk &c)
+{
+    for (int lod = 0; lod < LODS; ++lod)
+    {
+        if (!c.built[lod])
+            continue;
+        Mesh &m = c.lods[lod];
+        glDeleteVertexArrays(1, &m.VAO);
+        glDeleteBuffers(1, &m.VBO);
+        glDeleteBuffers(1, &m.EBO);
+        m = Mesh();
+        c.built[lod] = false;
+    }
+    c.lod = -1;
+}
@@ -0,0 +1,72 @@
+#ifndef TERRAINMESH_HPP
+#define TERRAINMESH_HPP
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Heightfield.hpp"
+#include "Mesh.hpp"
+#include "Shader.hpp"
+#include "Texture.hpp"
+
+namespace GE
+{
+    // Render side of a Heightfield: the grid is split into square chunks and a
+    // chunk only gets a mesh once the camera comes within `loadDistance`.
+    // Farther chunks are built from every 2nd, 4th... sample, and chunks past
+    // `unloadDistance` give their buffers back. Every chunk has a skirt hanging
+    // below its border, which hides the cracks between neighbours of different
+    // detail.
+    struct TerrainMesh
+    {
+        static constexpr int LODS = 4;
+
+        // `origin` is where the heightfield's local origin is drawn, as in Physics::addHeightfield.
+        TerrainMesh(const Heightfield &field, glm::vec3 origin, const std::string &texture, int chunkCells = 64);
+        TerrainMesh(const TerrainMesh &) = delete;
+        TerrainMesh &operator=(const TerrainMesh &) = delete;
+        ~TerrainMesh();
+
+        // Render thread, once per frame: builds, drops and re-details chunks around `eye`.
+        void update(const glm::vec3 &eye);
+        // The caller sets up the shader, `model` included (see getModelMatrix()).
+        void Draw(Shader &shader) const;
+        glm::mat4 getModelMatrix() const;
+
+        float loadDistance = 350.0f;
+        float unloadDistance = 450.0f;
+        // A chunk uses LOD l when farther than lodDistance * 2^(l-1).
+        float lodDistance = 80.0f;
+        // Chunk meshes built per update(), to spread the cost of flying into new ground.
+        int buildsPerFrame = 2;
+        // World units one texture repeat covers.
+        float textureSize = 16.0f;
+        // Entity id written into the picking buffer.
+        unsigned int objectId = 0;
+
+        std::size_t loadedChunks() const;
+
+    private:
+        struct Chunk
+        {
+            int x0, z0, x1, z1;    // sample range, inclusive
+            glm::vec3 center;
+            Mesh lods[LODS];
+            bool built[LODS] = {};
+            int lod = -1;          // drawn level, -1 = not drawn
+        };
+
+        const Heightfield &field;
+        glm::vec3 origin;
+        Texture texture;
+        int chunkCells;
+        std::vector<Chunk> chunks;
+
+        void build(Chunk &chunk, int lod);
+        void unload(Chunk &chunk);
+    };
+} // namespace GE
+
+#endif
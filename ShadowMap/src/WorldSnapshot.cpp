@@ -0,0 +1,189 @@
+#include "WorldSnapshot.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    constexpr char MAGIC[4] = {'G', 'E', 'W', 'S'};
+    constexpr std::uint32_t VERSION = 1;
+
+    struct Header
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t frame;
+        std::uint32_t count;
+    };
+
+    static_assert(std::is_trivially_copyable_v<GE::WorldSnapshot::Record>);
+
+    void Apply(GE::Physics &physics, GE::Entity &entity, const GE::WorldSnapshot::Record &r)
+    {
+        btRigidBody *rb = entity.body;
+        const btTransform t(btQuaternion(r.rotation[0], r.rotation[1], r.rotation[2], r.rotation[3]),
+                            btVector3(r.origin[0], r.origin[1], r.origin[2]));
+        const btVector3 linear(r.linearVelocity[0], r.linearVelocity[1], r.linearVelocity[2]);
+        const btVector3 angular(r.angularVelocity[0], r.angularVelocity[1], r.angularVelocity[2]);
+
+        rb->setWorldTransform(t);
+        rb->setInterpolationWorldTransform(t);
+        rb->setLinearVelocity(linear);
+        rb->setAngularVelocity(angular);
+        rb->setInterpolationLinearVelocity(linear);
+        rb->setInterpolationAngularVelocity(angular);
+        rb->clearForces();
+        rb->forceActivationState(r.activationState);
+        rb->setDeactivationTime(r.deactivationTime);
+
+        if (entity.transforms)
+            entity.transforms->reset(entity.renderSlot, t);
+
+        // Contacts cached for the old pose would warm start the solver with
+        // impulses from a different state.
+        if (btBroadphaseProxy *proxy = rb->getBroadphaseHandle())
+        {
+            physics.dynamicsWorld->updateSingleAabb(rb);
+            physics.broadphase->getOverlappingPairCache()->cleanProxyFromPairs(proxy, physics.dispatcher);
+        }
+    }
+} // namespace
+
+GE::WorldSnapshot GE::WorldSnapshot::Capture(const Physics &physics, const EntityManager &entities)
+{
+    WorldSnapshot snapshot;
+    snapshot.frame = physics.frame;
+    snapshot.records.reserve(entities.Entities.size());
+
+    for (const Entity *e : entities.Entities)
+    {
+        const btRigidBody *rb = e->body;
+        if (!rb)
+            continue;
+
+        Record r{};
+        r.id = e->m_id;
+        r.type = static_cast<std::uint8_t>(e->getType());
+        r.collisionFlags = rb->getCollisionFlags();
+        r.activationState = rb->getActivationState();
+        r.deactivationTime = rb->getDeactivationTime();
+
+        const glm::vec3 scale = e->getScale();
+        const btTransform &t = rb->getWorldTransform();
+        const btQuaternion q = t.getRotation();
+        for (int a = 0; a < 3; ++a)
+        {
+            r.scale[a] = scale[a];
+            r.origin[a] = t.getOrigin()[a];
+            r.linearVelocity[a] = rb->getLinearVelocity()[a];
+            r.angularVelocity[a] = rb->getAngularVelocity()[a];
+        }
+        r.rotation[0] = q.x();
+        r.rotation[1] = q.y();
+        r.rotation[2] = q.z();
+        r.rotation[3] = q.w();
+        snapshot.records.push_back(r);
+    }
+    return snapshot;
+}
+
+void GE::WorldSnapshot::restore(Physics &physics, EntityManager &entities, const Spawner &spawn) const
+{
+    std::unordered_map<unsigned int, Entity *> live;
+    std::unordered_set<unsigned int> taken;
+    for (Entity *e : entities.Entities)
+    {
+        taken.insert(e->m_id);
+        if (e->body)
+            live.emplace(e->m_id, e);
+    }
+
+    std::unordered_set<const Entity *> kept;
+    for (const Record &r : records)
+    {
+        const EntityType type = static_cast<EntityType>(r.type);
+        const glm::vec3 scale{r.scale[0], r.scale[1], r.scale[2]};
+
+        // Ids are only unique within one process, a snapshot from another run
+        // can name an entity of a different kind. That one is despawned below.
+        auto it = live.find(r.id);
+        if (it != live.end() && it->second->getType() == type && it->second->getScale() == scale)
+        {
+            kept.insert(it->second);
+            Apply(physics, *it->second, r);
+            continue;
+        }
+
+        Entity *e = spawn(type, scale, r.collisionFlags);
+        if (!e || !e->body)
+            continue;
+        // Keep the id so a later restore finds it again, unless another
+        // entity, bodiless or about to be despawned, still holds it.
+        if (taken.insert(r.id).second)
+        {
+            e->m_id = r.id;
+            Entity::id = Entity::id > r.id ? Entity::id : r.id + 1;
+        }
+        else
+            taken.insert(e->m_id);
+        kept.insert(e);
+        Apply(physics, *e, r);
+    }
+
+    for (auto &[id, e] : live)
+        if (!kept.count(e))
+            physics.despawn(*e);
+    physics.updateBodies();
+
+    physics.frame = frame;
+    physics.transforms.tick = frame;
+    physics.accumulator = 0.0f;
+}
+
+std::vector<char> GE::WorldSnapshot::serialize() const
+{
+    Header header{{MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]}, VERSION, frame, static_cast<std::uint32_t>(records.size())};
+    std::vector<char> data(sizeof(header) + records.size() * sizeof(Record));
+    std::memcpy(data.data(), &header, sizeof(header));
+    if (!records.empty())
+        std::memcpy(data.data() + sizeof(header), records.data(), records.size() * sizeof(Record));
+    return data;
+}
+
+bool GE::WorldSnapshot::deserialize(const char *data, std::size_t size)
+{
+    Header header;
+    if (size < sizeof(header))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, 4) != 0 || header.version != VERSION ||
+        size != sizeof(header) + std::size_t(header.count) * sizeof(Record))
+        return false;
+
+    frame = header.frame;
+    records.resize(header.count);
+    if (header.count)
+        std::memcpy(records.data(), data + sizeof(header), header.count * sizeof(Record));
+    return true;
+}
+
+bool GE::WorldSnapshot::save(const std::string &path) const
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    const std::vector<char> data = serialize();
+    out.write(data.data(), data.size());
+    return bool(out);
+}
+
+bool GE::WorldSnapshot::load(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    std::vector<char> data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    return deserialize(data.data(), data.size());
+}
@@ -0,0 +1,60 @@
+#ifndef WORLDSNAPSHOT_HPP
+#define WORLDSNAPSHOT_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Physics.hpp"
+#include "EntityManager.hpp"
+
+namespace GE
+{
+    // State of every entity that has a body: type, shape size, transform,
+    // velocities and activation, as fixed size records in one flat array.
+    //
+    // restore() matches records to live entities by id, type and scale and
+    // overwrites their bodies in place, which makes it usable for rollback.
+    // Records with no such entity are spawned through a callback, and bodies
+    // that are not matched are despawned the usual way (Physics::despawned). Saved
+    // to disk, a snapshot of a settled scene skips the settling on startup.
+    //
+    // Must not run concurrently with stepping: stop the PhysicsThread first.
+    struct WorldSnapshot
+    {
+        struct Record
+        {
+            std::uint32_t id;
+            std::uint8_t type;              // EntityType
+            std::uint8_t pad[3];
+            std::int32_t collisionFlags;
+            std::int32_t activationState;
+            float deactivationTime;
+            float scale[3];                 // Entity::getScale(), i.e. the shape size
+            float origin[3];
+            float rotation[4];              // quaternion x y z w
+            float linearVelocity[3];
+            float angularVelocity[3];
+        };
+
+        // Creates the entity (in the EntityManager) and its body for a record
+        // with no live entity. Where it is put does not matter.
+        using Spawner = std::function<Entity *(EntityType type, glm::vec3 scale, int collisionFlags)>;
+
+        unsigned int frame = 0;
+        std::vector<Record> records;
+
+        static WorldSnapshot Capture(const Physics &physics, const EntityManager &entities);
+        void restore(Physics &physics, EntityManager &entities, const Spawner &spawn) const;
+
+        std::vector<char> serialize() const;
+        bool deserialize(const char *data, std::size_t size);
+        bool save(const std::string &path) const;
+        bool load(const std::string &path);
+    };
+} // namespace GE
+
+#endif
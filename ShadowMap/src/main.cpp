@@ -13,7 +13,9 @@
 
 #include <btBulletDynamicsCommon.h>
 
+#include <atomic>
 #include <filesystem>
+#include <memory>
 #include <random>
 
 #include "Model.hpp"
@@ -22,8 +24,15 @@
 #include "Skybox.hpp"
 #include "Framebuffer.hpp"
 #include "Physics.hpp"
+#include "PhysicsThread.hpp"
 #include "DepthBuffer.hpp"
 #include "Render.hpp"
+#include "WorldSnapshot.hpp"
+#include "InputRecording.hpp"
+#include "Heightfield.hpp"
+#include "TerrainMesh.hpp"
+#include "Particles.hpp"
+#include "ParticleRenderer.hpp"
 
 #define MAX(X, Y) ((X > Y) ? X : Y)
 #define MIN(X, Y) ((X < Y) ? X : Y)
@@ -44,9 +53,23 @@ void throwRandomBall();
 void shotTheBall(bool fast);
 void shotTheCube(bool fast);
 void shotTheDonut(bool fast);
+GE::RecordedSpawn aimSpawn(GE::EntityType type, bool fast);
+GE::Entity *createSpawned(const GE::RecordedSpawn &s);
+void addSpawnedBody(GE::Physics &physics, GE::Entity &e, const GE::RecordedSpawn &s);
+void launch(const GE::RecordedSpawn &s);
+void replayFrame();
+void dropPile();
+void toggleDebris();
+void sprayParticles();
+void rayPick();
+bool InitTerrain(const char *heightmap);
+const std::vector<float> &donutPoints();
+void saveSnapshot();
+void restoreSnapshot();
 void ballCollisionCB(btRigidBody *rb);
 void print_FPS();
 void pickEntity();
+void InitCollisionEvents();
 
 PickingFramebuffer *pickingBuffer;
 
@@ -59,8 +82,37 @@ Camera camera(INITIAL_POS);
 // Entity Manager
 GE::EntityManager EntManager;
 
+// Terrain, collision and chunked render mesh. The heightfield has to outlive the bodies using it.
+std::unique_ptr<GE::Heightfield> terrainField;
+std::unique_ptr<GE::TerrainMesh> terrainMesh;
+glm::vec3 terrainOrigin{0};
+
+// Cosmetic balls outside the Bullet world (F4), simulated and drawn on the render thread.
+GE::DebrisParticles particles;
+std::unique_ptr<GE::ParticleRenderer> particleRenderer;
+
 // PHYSICS
-GE::Physics WorldPhysics;
+// Built and stepped on PhysicsLoop's thread, which also drives Bullet's task
+// scheduler, so the world and the query batches spread over every core.
+GE::PhysicsConfig PhysicsSetup()
+{
+    GE::PhysicsConfig config;
+    config.multithreaded = true;
+    return config;
+}
+GE::PhysicsThread PhysicsLoop{PhysicsSetup()};
+GE::Physics &WorldPhysics = PhysicsLoop.get();
+
+// Input recording (--record file) and replay (--replay file)
+std::unique_ptr<GE::InputRecorder> recorder;
+std::unique_ptr<GE::InputReplay> replay;
+
+// Per step physics profile (--stats file.csv|file.json)
+GE::PhysicsStatsLog statsLog;
+
+// Hard hits reported by the collision events, counted by the subscriber that
+// collisionEvents.dispatch() calls on the render thread.
+std::atomic<unsigned int> hardHits{0};
 
 // RENDER
 GE::Render render{EntManager, (int)WIDTH, (int)HEIGHT};
@@ -75,6 +127,32 @@ const Model *halfdonut_model;
 
 int main(int argc, char **argv)
 {
+    const char *record_path = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string opt = argv[i];
+        if (opt == "--record")
+        {
+            record_path = argv[i + 1];
+            recorder = std::make_unique<GE::InputRecorder>();
+        }
+        else if (opt == "--replay")
+        {
+            GE::InputRecording recording;
+            if (recording.load(argv[i + 1]))
+                replay = std::make_unique<GE::InputReplay>(std::move(recording));
+            else
+                printf("Could not load recording %s\n", argv[i + 1]);
+        }
+        else if (opt == "--stats")
+        {
+            if (statsLog.open(argv[i + 1]))
+                WorldPhysics.profile = true;
+            else
+                printf("Could not write %s\n", argv[i + 1]);
+        }
+    }
+
     GLFWwindow *window = InitDefaults();
 
     // Skybox
@@ -124,8 +202,31 @@ int main(int argc, char **argv)
     auto position = glm::vec3{0, 00, 00};
     auto dimensions = glm::vec2{20, 20};
 
-    WorldPhysics.add2DBOX(EntManager.createEntity<Ground>(ground_model, position, dimensions, rotation),
-                          position, dimensions, rotation, btCollisionObject::CollisionFlags::CF_STATIC_OBJECT);
+    if (!InitTerrain("textures/terrain.png"))
+    {
+        WorldPhysics.add2DBOX(EntManager.createEntity<Ground>(ground_model, position, dimensions, rotation),
+                              position, dimensions, rotation, btCollisionObject::CollisionFlags::CF_STATIC_OBJECT);
+        // The flat ground is a 40x40 slab, particles fall off its edges like the bodies do.
+        particles.groundPlane = false;
+        particles.boxes.push_back({position - glm::vec3{dimensions.x, 1.0f, dimensions.y}, position + glm::vec3{dimensions.x, 0.0f, dimensions.y}});
+    }
+    else
+    {
+        particles.field = terrainField.get();
+        particles.fieldOrigin = terrainOrigin;
+    }
+    particleRenderer = std::make_unique<GE::ParticleRenderer>(*sphere_model);
+    render.setParticles(particleRenderer.get());
+
+    // Static level pieces end up in one BVH triangle mesh body.
+    Ground &statics = EntManager.createEntity<Ground>(nullptr, glm::vec3{0}, glm::vec2{1, 1});
+    if (!WorldPhysics.mergeStatics(statics, "static_world"))
+        EntManager.destroyEntity(&statics);
+
+    InitCollisionEvents();
+    // A replay ticks the world from the render loop, one tick per frame.
+    if (!replay)
+        PhysicsLoop.start();
 
     // OUR LIGHT
     glm::vec3 LightInitPosition{0, 40, 40};
@@ -138,18 +239,59 @@ int main(int argc, char **argv)
     //  RENDER LOOP                                                                                       //
     ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+    std::vector<GE::Entity *> despawned;
+    unsigned int statsFrame = 0;
     while (!glfwWindowShouldClose(window))
     {
         // input
         // -----
         calculateDeltaTime();
-        WorldPhysics.step(deltaTime);
-        WorldPhysics.updateBodies();
-        WorldPhysics.Collision();
+        if (replay)
+        {
+            replayFrame();
+            if (statsLog.isOpen() && WorldPhysics.stats.frame != statsFrame)
+                statsLog.write(WorldPhysics.stats);
+            statsFrame = WorldPhysics.stats.frame;
+            if (replay->finished(WorldPhysics.frame))
+                glfwSetWindowShouldClose(window, true);
+        }
+        else
+        {
+            const GE::TransformSnapshot &snapshot = PhysicsLoop.acquire();
+            render.useSnapshot(&snapshot);
+            render.setInterpolation(PhysicsLoop.getInterpolationAlpha(snapshot));
+            WorldPhysics.collisionEvents.dispatch();
+            despawned.clear();
+            PhysicsLoop.collectDespawned(snapshot, despawned);
+            for (GE::Entity *e : despawned)
+                EntManager.destroyEntity(e);
+            // Only the steps that reach a frame are logged when rendering is slower than physics.
+            if (statsLog.isOpen() && snapshot.stats.frame != statsFrame)
+                statsLog.write(snapshot.stats);
+            statsFrame = snapshot.stats.frame;
+            // Stamped with the tick the viewer is applied before, like launch(),
+            // so a replay makes the same sleep decisions.
+            PhysicsLoop.enqueue([pose = GE::RecordedCamera{0, camera.Position, camera.Yaw, camera.Pitch}, direction = camera.GetViewDirection()](GE::Physics &physics) mutable
+                                {
+                                    physics.lod.setViewer(pose.position, direction);
+                                    if (recorder)
+                                    {
+                                        pose.frame = physics.frame;
+                                        recorder->camera(pose);
+                                    }
+                                });
+        }
+
+        if (terrainMesh)
+            terrainMesh->update(camera.Position);
+        // Long frames are cut short rather than letting particles tunnel through the ground.
+        particles.update(deltaTime < 1.0f / 30.0f ? deltaTime : 1.0f / 30.0f);
+        particleRenderer->upload(particles);
 
         light.mPosition = glm::vec3(50 * glm::sin(3.14f / 8.0f * lastFrame), LightInitPosition.y, 50 * glm::cos(3.14f / 8.0f * lastFrame));
         // print_FPS();
         processInput(window);
+        render.prepareFrame();
 
         pickingFramebuffer.Bind();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -167,8 +309,6 @@ int main(int argc, char **argv)
         skybox.Draw(camera);
         framebuffer.DrawFrame(framebufferShader);
 
-        WorldPhysics.updateBodies();
-
         glfwSwapInterval(1);
         glfwSwapBuffers(window);
         glfwPollEvents();
@@ -179,6 +319,14 @@ int main(int argc, char **argv)
     }
     ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+    PhysicsLoop.stop();
+    if (recorder && recorder->save(record_path))
+        printf("Input recorded to %s\n", record_path);
+    // GL buffers, before the context goes away.
+    render.setTerrain(nullptr);
+    terrainMesh.reset();
+    render.setParticles(nullptr);
+    particleRenderer.reset();
     glfwTerminate();
 
     return 0;
@@ -227,6 +375,9 @@ void processInput(GLFWwindow *window)
 
     if ((glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) || (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS))
         glfwSetWindowShouldClose(window, true);
+    // The recording drives the camera and the spawns.
+    if (replay)
+        return;
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
         camera.ProcessKeyboard(FORWARD, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
@@ -322,11 +473,25 @@ void mouse_callback(GLFWwindow *window, double xposIn, double yposIn)
     lastX = xpos;
     lastY = ypos;
 
-    camera.ProcessMouseMovement(xoffset, yoffset);
+    if (!replay)
+        camera.ProcessMouseMovement(xoffset, yoffset);
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods)
 {
+    // Piles, filter changes and restores are not recorded, they would take a replay off the recorded timeline.
+    if (action != GLFW_PRESS || replay || (recorder && (key == GLFW_KEY_F2 || key == GLFW_KEY_F3 || key == GLFW_KEY_F9)))
+        return;
+    if (key == GLFW_KEY_F2)
+        dropPile();
+    if (key == GLFW_KEY_F3)
+        toggleDebris();
+    if (key == GLFW_KEY_F4)
+        sprayParticles();
+    if (key == GLFW_KEY_F5)
+        saveSnapshot();
+    if (key == GLFW_KEY_F9)
+        restoreSnapshot();
 }
 
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
@@ -338,6 +503,8 @@ void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 {
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
         pickEntity();
+    if (button == GLFW_MOUSE_BUTTON_MIDDLE && action == GLFW_PRESS)
+        rayPick();
 }
 
 void calculateDeltaTime()
@@ -349,45 +516,300 @@ void calculateDeltaTime()
 
 void shotTheBall(bool fast)
 {
-    glm::vec3 camDir{camera.GetViewDirection()};
-    glm::vec3 position{camera.Position + (1.0f + 3.0f) * camDir};
-    glm::vec3 v = fast ? 200.0f * camDir : glm::vec3{0};
-    int max = 2;
-    float radius = 1.0f;
-    Ball &b = EntManager.createEntity<Ball>(sphere_model, position, v, radius);
-    WorldPhysics.addSphereBOX(b, position, radius, v, {});
-    auto pointer = b.body->getUserPointer();
-    /*
-    printf("Sphere created in {%03.2f, %03.2f, %03.2f} dir {%03.2f, %03.2f, %03.2f}\n",
-    position.x, position.y, position.z, glm::normalize(camDir).x, glm::normalize(camDir).y, glm::normalize(camDir).z);
-    */
+    launch(aimSpawn(GE::EntityType::Ball, fast));
 }
 
 void shotTheCube(bool fast)
 {
-    glm::vec3 camDir{camera.GetViewDirection()};
-    glm::vec3 position{camera.Position + (1.0f + 3.0f) * camDir};
-    glm::vec3 v = fast ? 200.0f * camDir : glm::vec3{0};
-    glm::mat4 rot = camera.GetViewMatrix();
-    glm::vec3 size{1, 1, 1};
-    WorldPhysics.addRigidBOX(EntManager.createEntity<ThrowingCube>(cube_model, position, size, v, rot), position, size, v, rot, {});
+    launch(aimSpawn(GE::EntityType::ThrowingCube, fast));
 }
 
 void shotTheDonut(bool fast)
+{
+    launch(aimSpawn(GE::EntityType::Donut, fast));
+}
+
+// A body launched from just in front of the camera, along the view direction.
+GE::RecordedSpawn aimSpawn(GE::EntityType type, bool fast)
 {
     glm::vec3 camDir{camera.GetViewDirection()};
     glm::vec3 position{camera.Position + (1.0f + 3.0f) * camDir};
     glm::vec3 v = fast ? 200.0f * camDir : glm::vec3{0};
-    glm::mat4 rot = camera.GetViewMatrix();
-    glm::vec3 size{1, 1, 1};
-    float radius = 1.0;
-    auto pos_vector = donut_model->GetRawPositions();
-    WorldPhysics.addRigidBoxFromModel(EntManager.createEntity<Donut>(donut_model, position, v, radius), donut_model->name, pos_vector.data(), pos_vector.size(), position, v, rot, {});
+    glm::mat4 rot = type == GE::EntityType::Ball ? glm::mat4{1.0f} : camera.GetViewMatrix();
+    return {0, type, glm::vec3{1, 1, 1}, position, v, rot};
+}
+
+GE::Entity *createSpawned(const GE::RecordedSpawn &s)
+{
+    switch (s.type)
+    {
+    case GE::EntityType::Ball:
+        return &EntManager.createEntity<Ball>(sphere_model, s.position, s.velocity, s.size.x);
+    case GE::EntityType::ThrowingCube:
+        return &EntManager.createEntity<ThrowingCube>(cube_model, s.position, s.size, s.velocity, s.rotation);
+    case GE::EntityType::Donut:
+        return &EntManager.createEntity<Donut>(donut_model, s.position, s.velocity, s.size.x);
+    default:
+        return nullptr;
+    }
+}
+
+void addSpawnedBody(GE::Physics &physics, GE::Entity &e, const GE::RecordedSpawn &s)
+{
+    switch (s.type)
+    {
+    case GE::EntityType::Ball:
+        physics.addSphereBOX(e, s.position, s.size.x, s.velocity, {});
+        break;
+    case GE::EntityType::ThrowingCube:
+        physics.addRigidBOX(e, s.position, s.size, s.velocity, s.rotation, {});
+        break;
+    case GE::EntityType::Donut:
+        physics.addDecomposedModel(e, donut_model->name, "models/donut.obj.hulls", donutPoints().data(), donutPoints().size(), s.position, s.velocity, s.rotation, {});
+        break;
+    default:
+        break;
+    }
+}
+
+// The entity is created here, its body on the physics thread. The spawn is
+// stamped with the tick it lands before, which is what a replay keys on.
+void launch(const GE::RecordedSpawn &s)
+{
+    GE::Entity *e = createSpawned(s);
+    if (!e)
+        return;
+    PhysicsLoop.enqueue([e, s](GE::Physics &physics)
+                        {
+                            addSpawnedBody(physics, *e, s);
+                            if (recorder)
+                            {
+                                GE::RecordedSpawn stamped = s;
+                                stamped.frame = physics.frame;
+                                recorder->spawn(stamped);
+                            }
+                        });
+}
+
+// F2: a 10x10x10 block of balls in front of the camera, spawned as one batch.
+void dropPile()
+{
+    constexpr int side = 10;
+    const float radius = 1.0f;
+    glm::vec3 corner{camera.Position + 30.0f * camera.GetViewDirection()};
+    std::vector<glm::vec3> positions;
+    positions.reserve(side * side * side);
+    for (int i = 0; i < side; ++i)
+        for (int j = 0; j < side; ++j)
+            for (int k = 0; k < side; ++k)
+                positions.push_back(corner + 2.5f * glm::vec3(i, j, k));
+
+    auto balls = EntManager.createEntities<Ball>(sphere_model, positions.size(), [&](std::size_t i)
+                                                 { return Ball(positions[i], glm::vec3{0}, radius); });
+    PhysicsLoop.enqueue([entities = std::vector<GE::Entity *>(balls.begin(), balls.end()), positions = std::move(positions), radius](GE::Physics &physics)
+                        { physics.spawnSpheres(entities, positions, {}, radius, {}); });
+}
+
+// F4: a burst of cosmetic balls out of the camera, particles only, no bodies.
+void sprayParticles()
+{
+    constexpr int count = 20000;
+    static std::mt19937 rng{1234};
+    std::uniform_real_distribution<float> spread(-0.25f, 0.25f), speed(20.0f, 40.0f), size(0.1f, 0.3f);
+
+    const glm::vec3 forward = camera.GetViewDirection();
+    const glm::vec3 origin = camera.Position + 3.0f * forward;
+    int spawned = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        glm::vec3 direction = glm::normalize(forward + glm::vec3{spread(rng), spread(rng), spread(rng)});
+        spawned += particles.spawn(origin, speed(rng) * direction, size(rng));
+    }
+    printf("%d particles spawned, %zu alive\n", spawned, particles.size());
+}
+
+// Middle click: what the crosshair points at, found with a ray query instead of the picking buffer.
+void rayPick()
+{
+    const GE::RayQuery ray{camera.Position, camera.Position + 500.0f * camera.GetViewDirection()};
+    auto report = [ray](const GE::Physics &physics)
+    {
+        GE::QueryHit hit;
+        physics.rayTestBatch({&ray, 1}, {&hit, 1});
+        if (hit.entity)
+            printf("Ray hit entity %u at { %.2f, %.2f, %.2f }\n", hit.entity->m_id, hit.point.x, hit.point.y, hit.point.z);
+        else
+            printf("Ray hit nothing\n");
+    };
+    // Queries only run between steps, on the physics thread.
+    PhysicsLoop.enqueue([report](GE::Physics &physics)
+                        { report(physics); });
+}
+
+// Replays one tick of the recording, waiting for it every frame, so that every
+// frame advances the world by exactly one fixed step whatever the frame rate.
+// The tick still runs on the physics thread, the one driving the scheduler.
+void replayFrame()
+{
+    if (const GE::RecordedCamera *c = replay->cameraAt(WorldPhysics.frame))
+    {
+        camera.Position = c->position;
+        camera.Yaw = c->yaw;
+        camera.Pitch = c->pitch;
+        camera.ProcessMouseMovement(0.0f, 0.0f);
+    }
+
+    PhysicsLoop.call([position = camera.Position, direction = camera.GetViewDirection()](GE::Physics &physics)
+                     {
+                         replay->spawnsAt(physics.frame, [&](const GE::RecordedSpawn &s)
+                                          {
+                                              if (GE::Entity *e = createSpawned(s))
+                                                  addSpawnedBody(physics, *e, s);
+                                          });
+                         physics.lod.setViewer(position, direction);
+                         physics.step(1.0f / physics.tickRate);
+                         physics.updateBodies();
+                     });
+    render.useSnapshot(nullptr);
+    render.setInterpolation(1.0f);
+    WorldPhysics.collisionEvents.dispatch();
+    for (const auto &d : WorldPhysics.despawned)
+        EntManager.destroyEntity(d.entity);
+    WorldPhysics.despawned.clear();
+}
+
+const std::vector<float> &donutPoints()
+{
+    static const auto pos_vector = donut_model->GetRawPositions();
+    return pos_vector;
+}
+
+// F3: projectiles stop colliding with each other and only hit the world.
+void toggleDebris()
+{
+    PhysicsLoop.enqueue([](GE::Physics &physics)
+                        {
+                            physics.collisionFilter.setDebris(!physics.collisionFilter.isDebris());
+                            physics.refilterBodies();
+                            printf("Debris mode %s\n", physics.collisionFilter.isDebris() ? "on" : "off");
+                        });
+}
+
+// F5 / F9. The physics thread is paused so the world holds still while it is read or rewritten.
+void saveSnapshot()
+{
+    PhysicsLoop.stop();
+    GE::WorldSnapshot snapshot = GE::WorldSnapshot::Capture(WorldPhysics, EntManager);
+    PhysicsLoop.start();
+    if (snapshot.save("snapshot.bin"))
+        printf("Snapshot of %zu bodies saved\n", snapshot.records.size());
+}
+
+void restoreSnapshot()
+{
+    GE::WorldSnapshot snapshot;
+    if (!snapshot.load("snapshot.bin"))
+    {
+        printf("No snapshot to restore\n");
+        return;
+    }
+
+    glm::vec3 origin{0};
+    glm::mat4 rot{1.0f};
+    PhysicsLoop.stop();
+    snapshot.restore(WorldPhysics, EntManager, [&](GE::EntityType type, glm::vec3 scale, int flags) -> GE::Entity *
+                     {
+                         auto cf = static_cast<btCollisionObject::CollisionFlags>(flags);
+                         switch (type)
+                         {
+                         case GE::EntityType::Ball:
+                         {
+                             Ball &b = EntManager.createEntity<Ball>(sphere_model, origin, origin, scale.x);
+                             WorldPhysics.addSphereBOX(b, origin, scale.x, origin, cf);
+                             return &b;
+                         }
+                         case GE::EntityType::ThrowingCube:
+                         {
+                             ThrowingCube &c = EntManager.createEntity<ThrowingCube>(cube_model, origin, scale, origin, rot);
+                             WorldPhysics.addRigidBOX(c, origin, scale, origin, rot, cf);
+                             return &c;
+                         }
+                         case GE::EntityType::Donut:
+                         {
+                             Donut &d = EntManager.createEntity<Donut>(donut_model, origin, origin, scale.x);
+                             WorldPhysics.addDecomposedModel(d, donut_model->name, "models/donut.obj.hulls", donutPoints().data(), donutPoints().size(), origin, origin, rot, cf);
+                             return &d;
+                         }
+                         case GE::EntityType::Terrain:
+                         {
+                             if (!terrainField)
+                                 return nullptr;
+                             Terrain &t = EntManager.createEntity<Terrain>(nullptr, terrainOrigin);
+                             WorldPhysics.addHeightfield(t, *terrainField, terrainOrigin, cf);
+                             terrainMesh->objectId = t.m_id;
+                             return &t;
+                         }
+                         case GE::EntityType::Ground:
+                         {
+                             glm::vec2 dimensions{scale.x, scale.z};
+                             Ground &g = EntManager.createEntity<Ground>(ground_model, origin, dimensions, rot);
+                             WorldPhysics.add2DBOX(g, origin, dimensions, rot, cf);
+                             return &g;
+                         }
+                         default:
+                             return nullptr;
+                         } });
+    PhysicsLoop.start();
+    printf("Snapshot of %zu bodies restored\n", snapshot.records.size());
+}
+
+// Heightfield ground from the red channel of `heightmap`, centred so the
+// middle of the terrain is at y = 0. False when the image cannot be read.
+bool InitTerrain(const char *heightmap)
+{
+    int w, h, channels;
+    stbi_set_flip_vertically_on_load(false);
+    unsigned char *pixels = stbi_load(heightmap, &w, &h, &channels, 0);
+    if (!pixels)
+        return false;
+    terrainField = std::make_unique<GE::Heightfield>(GE::Heightfield::FromPixels(pixels, w, h, channels, 0.8f, 40.0f, 4));
+    stbi_image_free(pixels);
+
+    terrainOrigin = {0.0f, -terrainField->heightAt(0.0f, 0.0f), 0.0f};
+    Terrain &t = EntManager.createEntity<Terrain>(nullptr, terrainOrigin);
+    WorldPhysics.addHeightfield(t, *terrainField, terrainOrigin, btCollisionObject::CF_STATIC_OBJECT);
+
+    terrainMesh = std::make_unique<GE::TerrainMesh>(*terrainField, terrainOrigin, heightmap);
+    terrainMesh->objectId = t.m_id;
+    // Everything in reach on the first frame, lazily from then on.
+    terrainMesh->buildsPerFrame = 1 << 20;
+    terrainMesh->update(camera.Position);
+    terrainMesh->buildsPerFrame = 2;
+    render.setTerrain(terrainMesh.get());
+    return true;
 }
 
 void print_FPS()
 {
-    printf("FPS: %04d\r", (int)(1.0 / deltaTime));
+    printf("FPS: %04d  hits: %u\r", (int)(1.0 / deltaTime), hardHits.load(std::memory_order_relaxed));
+}
+
+void InitCollisionEvents()
+{
+    // Hard impacts between anything that moves, and on the ground. Begin only,
+    // so each pair is dropped from the watch list after its first tick.
+    const GE::CollisionEvents::PairRule hits{GE::CollisionEvent::Begin, 1000.0f};
+    const GE::EntityType types[] = {GE::EntityType::Ball, GE::EntityType::ThrowingCube, GE::EntityType::Donut, GE::EntityType::Ground, GE::EntityType::Terrain};
+    auto ground = [](GE::EntityType t)
+    { return t == GE::EntityType::Ground || t == GE::EntityType::Terrain; };
+    for (auto a : types)
+        for (auto b : types)
+            if (!ground(a) || !ground(b))
+                WorldPhysics.collisionEvents.setRule(a, b, hits);
+
+    // Only counted, a pile of boxes can report hundreds of these per tick.
+    WorldPhysics.collisionEvents.subscribe([](const GE::CollisionEvent &)
+                                           { hardHits.fetch_add(1, std::memory_order_relaxed); });
 }
 
 void ballCollisionCB(btRigidBody *rb)
@@ -1,6 +1,8 @@
 #ifndef ENTYTYMANAGER_HPP
 #define ENTITYMANAGER_HPP
 
+#include <algorithm>
+#include <unordered_set>
 #include <vector>
 
 #include <glm/glm.hpp>
@@ -32,14 +34,24 @@ struct EntityManager
             delete e;
     };
 
-    void update()
+    // Drops the entities whose bodies Physics::updateBodies() just freed
+    void update( const Physics& WorldPhysics )
     {
-        Entities.erase(std::remove_if(Entities.begin(), Entities.end(),[](auto &e){ return !e->body; }) ,Entities.end());
+        if (WorldPhysics.despawned.empty())
+            return;
+
+        std::unordered_set<const btRigidBody*> gone(WorldPhysics.despawned.begin(), WorldPhysics.despawned.end());
+        Entities.erase(std::remove_if(Entities.begin(), Entities.end(), [&gone](auto *e)
+        {
+            if (!gone.count(e->body))
+                return false;
+            delete e;
+            return true;
+        }), Entities.end());
     };
 
     void DrawEntities( Physics& WorldPhysics, Camera& camera )
     {
-        extern const float MAP_LIMITS;
         extern const unsigned int WIDTH;
         extern const unsigned int HEIGHT;
 
@@ -50,32 +62,24 @@ struct EntityManager
         {
             if (e->body != nullptr)
             {
-                btTransform t = e->body->getWorldTransform();
+                // Motion state holds the transform interpolated between physics ticks
+                btTransform t;
+                e->body->getMotionState()->getWorldTransform(t);
                 btQuaternion rotation   = t.getRotation();
                 btVector3 translate = t.getOrigin();
                 glm::vec3 scale = e->scale;
-                if (translate.getY() < -50.0f)
-                {
-                    delete e->body->getMotionState();
-                    delete e->body->getCollisionShape();
-                    WorldPhysics.dynamicsWorld->removeRigidBody(e->body);
-                    e->body = nullptr;
-                }
-                else
-                {
-                    glm::mat4 rotationMatrix = glm::rotate(glm::mat4(1.0), rotation.getAngle(), glm::vec3(rotation.getAxis().getX(), rotation.getAxis().getY(), rotation.getAxis().getZ()));
-                    glm::mat4 translationMatrix = glm::translate(glm::mat4(1.0), glm::vec3(translate.getX(), translate.getY(), translate.getZ()));
-                    glm::mat4 scaleMatrix = glm::scale(glm::mat4(1.0), scale);
-                    glm::mat4 model = translationMatrix * rotationMatrix * scaleMatrix;
+                glm::mat4 rotationMatrix = glm::rotate(glm::mat4(1.0), rotation.getAngle(), glm::vec3(rotation.getAxis().getX(), rotation.getAxis().getY(), rotation.getAxis().getZ()));
+                glm::mat4 translationMatrix = glm::translate(glm::mat4(1.0), glm::vec3(translate.getX(), translate.getY(), translate.getZ()));
+                glm::mat4 scaleMatrix = glm::scale(glm::mat4(1.0), scale);
+                glm::mat4 model = translationMatrix * rotationMatrix * scaleMatrix;
 
-                    e->default_shader->use();
-                    e->default_shader->setVec2("resolution", glm::vec2(WIDTH, HEIGHT));
-                    e->default_shader->setMat4("projection", projection);
-                    e->default_shader->setMat4("view", view);
-                    e->default_shader->setMat4("model", model);
-                    e->default_shader->setVec3("cameraPos", camera.Position);
-                    e->Draw();
-                }
+                e->default_shader->use();
+                e->default_shader->setVec2("resolution", glm::vec2(WIDTH, HEIGHT));
+                e->default_shader->setMat4("projection", projection);
+                e->default_shader->setMat4("view", view);
+                e->default_shader->setMat4("model", model);
+                e->default_shader->setVec3("cameraPos", camera.Position);
+                e->Draw();
             }
         }
     };
@@ -0,0 +1,115 @@
+#include "HullCache.hpp"
+
+#include <BulletCollision/CollisionShapes/btShapeHull.h>
+
+HullCache::~HullCache()
+{
+    for (auto &[key, hull] : hulls)
+        delete hull.shape;
+}
+
+const HullCache::Hull &HullCache::get(const std::string &key, const float *points, int n_floats)
+{
+    auto it = hulls.find(key);
+    if (it != hulls.end())
+        return it->second;
+    return hulls.emplace(key, Cook(points, n_floats)).first->second;
+}
+
+const HullCache::Hull *HullCache::find(const std::string &key) const
+{
+    auto it = hulls.find(key);
+    return it != hulls.end() ? &it->second : nullptr;
+}
+
+bool HullCache::owns(const btCollisionShape *shape) const
+{
+    for (const auto &[key, hull] : hulls)
+        if (hull.shape == shape)
+            return true;
+    return false;
+}
+
+// Volume, centre of mass and inertia of a closed triangle mesh, integrated
+// over the signed tetrahedra the triangles form with the origin
+// (D. Eberly, "Polyhedral Mass Properties").
+static void MassProperties(const btVector3 *v, const unsigned int *indices, int n_indices, HullCache::Hull &hull)
+{
+    btScalar in[10] = {};
+    for (int t = 0; t + 2 < n_indices; t += 3)
+    {
+        const btVector3 &p0 = v[indices[t]];
+        const btVector3 &p1 = v[indices[t + 1]];
+        const btVector3 &p2 = v[indices[t + 2]];
+        const btVector3 d = (p1 - p0).cross(p2 - p0);
+
+        btScalar f1[3], f2[3], f3[3], g0[3], g1[3], g2[3];
+        for (int a = 0; a < 3; ++a)
+        {
+            const btScalar w0 = p0[a], w1 = p1[a], w2 = p2[a];
+            const btScalar t0 = w0 + w1;
+            const btScalar t1 = w0 * w0;
+            const btScalar t2 = t1 + w1 * t0;
+            f1[a] = t0 + w2;
+            f2[a] = t2 + w2 * f1[a];
+            f3[a] = w0 * t1 + w1 * t2 + w2 * f2[a];
+            g0[a] = f2[a] + w0 * (f1[a] + w0);
+            g1[a] = f2[a] + w1 * (f1[a] + w1);
+            g2[a] = f2[a] + w2 * (f1[a] + w2);
+        }
+
+        in[0] += d.x() * f1[0];
+        in[1] += d.x() * f2[0];
+        in[2] += d.y() * f2[1];
+        in[3] += d.z() * f2[2];
+        in[4] += d.x() * f3[0];
+        in[5] += d.y() * f3[1];
+        in[6] += d.z() * f3[2];
+        in[7] += d.x() * (p0.y() * g0[0] + p1.y() * g1[0] + p2.y() * g2[0]);
+        in[8] += d.y() * (p0.z() * g0[1] + p1.z() * g1[1] + p2.z() * g2[1]);
+        in[9] += d.z() * (p0.x() * g0[2] + p1.x() * g1[2] + p2.x() * g2[2]);
+    }
+
+    // The winding btShapeHull produces is not guaranteed, flip inward meshes.
+    const btScalar sign = in[0] < 0 ? -1 : 1;
+    const btScalar volume = sign * in[0] / 6;
+    if (volume <= SIMD_EPSILON)
+        return;
+
+    const btScalar firstOrder = sign / 24, secondOrder = sign / 60;
+    btVector3 cm(in[1] * firstOrder, in[2] * firstOrder, in[3] * firstOrder);
+    cm /= volume;
+
+    const btScalar xx = in[4] * secondOrder, yy = in[5] * secondOrder, zz = in[6] * secondOrder;
+    hull.volume = volume;
+    hull.centerOfMass = cm;
+    // Products of inertia (in[7..9]) are dropped, Bullet only takes the diagonal.
+    hull.unitInertia = btVector3(yy + zz - volume * (cm.y() * cm.y() + cm.z() * cm.z()),
+                                 zz + xx - volume * (cm.z() * cm.z() + cm.x() * cm.x()),
+                                 xx + yy - volume * (cm.x() * cm.x() + cm.y() * cm.y())) /
+                       volume;
+}
+
+HullCache::Hull HullCache::Cook(const float *points, int n_floats)
+{
+    btConvexHullShape raw;
+    for (int i = 0; i + 2 < n_floats; i += 3)
+        raw.addPoint(btVector3(points[i], points[i + 1], points[i + 2]), false);
+    raw.recalcLocalAabb();
+
+    btShapeHull simplified(&raw);
+    simplified.buildHull(raw.getMargin());
+
+    Hull hull;
+    hull.shape = new btConvexHullShape(&simplified.getVertexPointer()->getX(), simplified.numVertices(), sizeof(btVector3));
+    hull.rawVertices = n_floats / 3;
+
+    // Fallback for degenerate (flat) input: the bounding sphere the bodies used before.
+    btScalar r;
+    hull.shape->getBoundingSphere(hull.centerOfMass, r);
+    hull.volume = 4.0f / 3.0f * SIMD_PI * r * r * r;
+    hull.unitInertia = btVector3(0.4f * r * r, 0.4f * r * r, 0.4f * r * r);
+
+    MassProperties(simplified.getVertexPointer(), simplified.getIndexPointer(), simplified.numIndices(), hull);
+    return hull;
+}
@@ -0,0 +1,46 @@
+#ifndef HULLCACHE_HPP
+#define HULLCACHE_HPP
+
+#include <string>
+#include <unordered_map>
+
+#include <btBulletDynamicsCommon.h>
+
+// Cooks model vertices into small convex hulls, once per model.
+//
+// Raw hitbox models have thousands of vertices and the cost of every
+// support query grows with them. The raw hull is resampled with
+// btShapeHull, which keeps only the vertices that are extreme along a fixed
+// set of directions (a few dozen at most), and the mass properties are
+// integrated over the simplified hull so mass and inertia match the shape
+// that is actually simulated.
+struct HullCache
+{
+    struct Hull
+    {
+        btConvexHullShape *shape;
+        btScalar volume;
+        btVector3 centerOfMass;     // hull space, models are expected to be centred on it
+        btVector3 unitInertia;      // principal moments for mass 1
+        int rawVertices;
+    };
+
+    HullCache() = default;
+    HullCache(const HullCache &) = delete;
+    HullCache &operator=(const HullCache &) = delete;
+    ~HullCache();
+
+    // `points` holds n_floats / 3 xyz triples. Cooked on the first call for a key.
+    const Hull &get(const std::string &key, const float *points, int n_floats);
+    const Hull *find(const std::string &key) const;
+    bool owns(const btCollisionShape *shape) const;
+
+    std::size_t size() const { return hulls.size(); }
+
+    static Hull Cook(const float *points, int n_floats);
+
+private:
+    std::unordered_map<std::string, Hull> hulls;
+};
+
+#endif
@@ -1,5 +1,8 @@
 #include "Physics.hpp"
 
+#include <algorithm>
+#include <cstdint>
+
 #define MAX(X, Y) ((X > Y) ? X : Y)
 #define MIN(X, Y) ((X < Y) ? X : Y)
 
@@ -12,11 +15,60 @@ Physics::Physics()
     dynamicsWorld           = new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
     
     dynamicsWorld->setGravity(btVector3(0, -100, 0));
+
+    ghostPairCallback = new btGhostPairCallback();
+    broadphase->getOverlappingPairCache()->setInternalGhostPairCallback(ghostPairCallback);
+
+    const float depth = 10000.0f;
+    killVolume = new btGhostObject();
+    killVolume->setCollisionShape(shapes.getBox(glm::vec3(depth, depth, depth)));
+    killVolume->setWorldTransform(btTransform(btQuaternion(0, 0, 0, 1), btVector3(0, killPlaneY - depth, 0)));
+    killVolume->setCollisionFlags(btCollisionObject::CF_NO_CONTACT_RESPONSE);
+    dynamicsWorld->addCollisionObject(killVolume, btBroadphaseProxy::SensorTrigger,
+                                      btBroadphaseProxy::AllFilter & ~(btBroadphaseProxy::StaticFilter | btBroadphaseProxy::SensorTrigger));
+}
+
+void Physics::despawn(btRigidBody *body)
+{
+    if (std::find(despawnQueue.begin(), despawnQueue.end(), body) == despawnQueue.end())
+        despawnQueue.push_back(body);
+}
+
+void Physics::updateBodies()
+{
+    despawned.clear();
+
+    // Only what is inside the volume is visited, bodies still in play cost nothing here
+    for (int i = 0; i < killVolume->getNumOverlappingObjects(); ++i)
+    {
+        btRigidBody *body = btRigidBody::upcast(killVolume->getOverlappingObject(i));
+        if (body && !body->isStaticOrKinematicObject())
+            despawn(body);
+    }
+
+    // Removing bodies edits the volume's overlap list, hence the queue
+    for (btRigidBody *body : despawnQueue)
+    {
+        dynamicsWorld->removeRigidBody(body);
+        delete body->getMotionState();
+        // Registry and hull cache shapes are shared, only owned ones are deleted here
+        btCollisionShape *shape = body->getCollisionShape();
+        if (!shapes.release(shape) && !hulls.owns(shape))
+            delete shape;
+        delete body;
+        despawned.push_back(body);
+    }
+    despawnQueue.clear();
+}
+
+void Physics::step(float deltaTime)
+{
+    dynamicsWorld->stepSimulation(deltaTime, maxCatchUpSteps, 1.0f / tickRate);
 }
 
 btRigidBody* Physics::addRigidBox(glm::vec3 pos, glm::vec3 sizes, btCollisionObject::CollisionFlags flags)
 {
-    btCollisionShape *shape            = new btBoxShape(btVector3(sizes.x, sizes.y, sizes.z));
+    btCollisionShape *shape            = shapes.getBox(sizes);
     btDefaultMotionState *MotionState  = new btDefaultMotionState(btTransform(btQuaternion(0, 0, 0, 1), btVector3(pos.x, pos.y, pos.z)));
     float mass;
     if( ! ( flags & btCollisionObject::CF_STATIC_OBJECT ) )
@@ -37,7 +89,7 @@ btRigidBody* Physics::addRigidBox(glm::vec3 pos, glm::vec3 sizes, btCollisionObj
 
 btRigidBody* Physics::addSphere(glm::vec3 pos, float radius,glm::vec3 velocity, btCollisionObject::CollisionFlags flags)
 {
-    btCollisionShape *sphereShape = new btSphereShape(radius);
+    btCollisionShape *sphereShape = shapes.getSphere(radius);
     btTransform initTransform(btQuaternion(0, 0, 0, 1), btVector3(pos.x, pos.y, pos.z));
     btDefaultMotionState *sphereMotionState = new btDefaultMotionState(initTransform);
 
@@ -57,38 +109,24 @@ btRigidBody* Physics::addSphere(glm::vec3 pos, float radius,glm::vec3 velocity,
 
 btRigidBody* Physics::addRigidBoxFromModel(Model& model, glm::vec3 pos, btCollisionObject::CollisionFlags flags)
 {
-
     // SHAPE
-    float *vertex_positions;
-    unsigned int hitbox_vertices = model.GetRawPositions(&vertex_positions);
-    btConvexHullShape *shape = new btConvexHullShape();
-    float max_x=-99999.0;
-    float min_x=99999.0;
-    float max_y=-99999.0;
-    float min_y=99999.0;
-    float max_z=-99999.0;
-    float min_z=99999.0;
-    
-    for (unsigned int i = 0; i < hitbox_vertices; i += 3)
+    std::string key = model.name.empty() ? std::to_string(reinterpret_cast<std::uintptr_t>(&model)) : model.name;
+    const HullCache::Hull *hull = hulls.find(key);
+    if (!hull)
     {
-        shape->addPoint(btVector3(vertex_positions[i], vertex_positions[i + 1], vertex_positions[i + 2]));
-        max_x = MAX(vertex_positions[i], max_x);
-        min_x = MIN(vertex_positions[i], min_x);
-        max_y = MAX(vertex_positions[i+1], max_y);
-        min_y = MIN(vertex_positions[i+1], min_y);
-        max_z = MAX(vertex_positions[i+2], max_z);
-        min_z = MIN(vertex_positions[i+2], min_z);
+        float *vertex_positions;
+        unsigned int hitbox_vertices = model.GetRawPositions(&vertex_positions);
+        hull = &hulls.get(key, vertex_positions, hitbox_vertices);
     }
 
     btDefaultMotionState *MotionState  = new btDefaultMotionState(btTransform(btQuaternion(0, 0, 0, 1), btVector3(pos.x, pos.y, pos.z)));
     float mass;
     if( ! ( flags & btCollisionObject::CF_STATIC_OBJECT ) )
-        mass = (max_x-min_y) * (max_y-min_y) * (max_z-min_z);
+        mass = hull->volume;
     else
         mass = 0.0f;
-    btVector3 Inertia(1, 1, 1);
-    shape->calculateLocalInertia(mass, Inertia);
-    btRigidBody::btRigidBodyConstructionInfo RigicBodyCI(mass, MotionState, shape, Inertia);
+    btVector3 Inertia = hull->unitInertia * mass;
+    btRigidBody::btRigidBodyConstructionInfo RigicBodyCI(mass, MotionState, hull->shape, Inertia);
     btRigidBody *body = new btRigidBody(RigicBodyCI);
     body->setRestitution(0.80f);
     body->setFriction(0.9f);
@@ -2,9 +2,14 @@
 #define PHYSICS_HPP
 
 #include <btBulletDynamicsCommon.h>
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
 #include <glm/glm.hpp>
 
+#include <vector>
+
 #include "Model.hpp"
+#include "ShapeRegistry.hpp"
+#include "HullCache.hpp"
 
 struct Physics
 {
@@ -15,6 +20,26 @@ struct Physics
     btCollisionDispatcher               *dispatcher;
     btSequentialImpulseConstraintSolver *solver;
     btDiscreteDynamicsWorld             *dynamicsWorld;
+    ShapeRegistry                       shapes;
+    HullCache                           hulls;
+
+    float tickRate          = 60.0f;
+    int   maxCatchUpSteps   = 5;
+
+    // Bodies falling below this are despawned
+    float killPlaneY        = -50.0f;
+    // Sensor filling everything under the kill plane, the broadphase tells it which bodies entered
+    btGhostObject                       *killVolume;
+    btGhostPairCallback                 *ghostPairCallback;
+    std::vector<btRigidBody*>           despawnQueue;
+    // Bodies freed by the last updateBodies(), to be compared against only
+    std::vector<const btRigidBody*>     despawned;
+
+    // Fixed 1/tickRate ticks; motion states receive the interpolated transform to draw with
+    void step( float deltaTime );
+    // Frees the bodies that reached the kill volume or were passed to despawn()
+    void updateBodies();
+    void despawn( btRigidBody* body );
 
     btRigidBody* addRigidBox( glm::vec3 pos, glm::vec3 sizes, btCollisionObject::CollisionFlags flags );
     btRigidBody* addRigidBoxFromModel( Model& model, glm::vec3 pos, btCollisionObject::CollisionFlags flags );
@@ -0,0 +1,83 @@
+#include "ShapeRegistry.hpp"
+
+#include <functional>
+
+ShapeRegistry::~ShapeRegistry()
+{
+    for (auto &[key, entry] : shapes)
+        delete entry.shape;
+}
+
+std::size_t ShapeRegistry::KeyHash::operator()(const Key &k) const
+{
+    std::size_t h = std::hash<float>{}(k.x);
+    h ^= std::hash<float>{}(k.y) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= std::hash<float>{}(k.z) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= static_cast<std::size_t>(k.type) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+}
+
+btCollisionShape *ShapeRegistry::acquire(const Key &key)
+{
+    auto it = shapes.find(key);
+    if (it != shapes.end())
+    {
+        ++it->second.refs;
+        return it->second.shape;
+    }
+
+    btCollisionShape *shape = nullptr;
+    switch (key.type)
+    {
+    case ShapeType::Sphere:
+        shape = new btSphereShape(key.x);
+        break;
+    case ShapeType::Box:
+        shape = new btBoxShape(btVector3(key.x, key.y, key.z));
+        break;
+    case ShapeType::Box2D:
+        shape = new btBox2dShape(btVector3(key.x, key.y, key.z));
+        break;
+    }
+
+    shapes.emplace(key, Entry{shape, 1});
+    keys.emplace(shape, key);
+    return shape;
+}
+
+btSphereShape *ShapeRegistry::getSphere(float radius)
+{
+    return static_cast<btSphereShape *>(acquire({ShapeType::Sphere, radius, 0.0f, 0.0f}));
+}
+
+btBoxShape *ShapeRegistry::getBox(const glm::vec3 halfExtents)
+{
+    return static_cast<btBoxShape *>(acquire({ShapeType::Box, halfExtents.x, halfExtents.y, halfExtents.z}));
+}
+
+btBox2dShape *ShapeRegistry::getBox2D(const glm::vec2 dimensions)
+{
+    return static_cast<btBox2dShape *>(acquire({ShapeType::Box2D, dimensions.x, 0.0f, dimensions.y}));
+}
+
+bool ShapeRegistry::release(const btCollisionShape *shape)
+{
+    auto k = keys.find(shape);
+    if (k == keys.end())
+        return false;
+
+    auto it = shapes.find(k->second);
+    if (--it->second.refs == 0)
+    {
+        delete it->second.shape;
+        shapes.erase(it);
+        keys.erase(k);
+    }
+    return true;
+}
+
+unsigned int ShapeRegistry::refCount(const btCollisionShape *shape) const
+{
+    auto k = keys.find(shape);
+    return k == keys.end() ? 0 : shapes.at(k->second).refs;
+}
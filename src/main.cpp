@@ -153,7 +153,10 @@ int main(int argc, char **argv)
         processInput(window);
 
         // Process Physics
-        WorldPhysics.dynamicsWorld->stepSimulation(deltaTime);
+        WorldPhysics.step(deltaTime);
+        WorldPhysics.updateBodies();
+        // Update Entitiy vector(remove), before anything touches the freed bodies
+        EntManager.update(WorldPhysics);
 
         // Bind Framebuffer
         framebuffer.Bind();
@@ -161,8 +164,6 @@ int main(int argc, char **argv)
 
         // Render ENtities
         EntManager.DrawEntities(WorldPhysics, camera);
-        // Update Entitiy vector(remove)
-        EntManager.update();
 
         // render SKYBOX
         skybox.Draw(camera);